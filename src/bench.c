@@ -0,0 +1,198 @@
+/////////////////////////////////////////////////////
+// CSC 252 Project 4
+// Cache Simulator
+// Wilfred Wallis and Chris Dalke
+/////////////////////////////////////////////////////
+// File: bench.c
+/////////////////////////////////////////////////////
+
+#include <time.h>
+#include <sys/resource.h>
+#include "cache.h"
+#include "trace.h"
+#include "model.h"
+#include "bench.h"
+
+/////////////////////////////////////////////////////
+// Throughput benchmark
+//
+// Streams the trace through each configuration in turn,
+// timing trace decoding and simulation separately around
+// every batch. Nothing is written per access, so the
+// numbers are the simulator's own cost. Results go to
+// stdout as a table and to a results file, JSON unless
+// its name ends in ".csv", for comparing runs.
+/////////////////////////////////////////////////////
+
+//Configurations benchmarked when none are given with -c / -configs:
+//the GOLD ones, then large caches and high associativity
+static const char * const benchSuite[] = {
+    "16:1:32",
+    "32:2:64",
+    "32:512:64",
+    "32:8:128:lru",
+    "1024:16:64:lru",
+    "8192:16:64:lru",
+    "64:1024:64:lru",
+    "256:64:64:plru",
+    "256:16:64:drrip",
+};
+#define BENCH_SUITE_SIZE (sizeof(benchSuite) / sizeof(benchSuite[0]))
+
+typedef struct {
+    cacheConfig config;
+    uint64_t accesses;
+    uint64_t misses;
+    double parseSeconds;
+    double simulateSeconds;
+    long peakRssKB;         //of the whole process so far
+} benchResult;
+
+static double benchNow(void){
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+//Peak resident set size in KB
+static long benchPeakRss(void){
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024; //bytes on macOS
+#else
+    return usage.ru_maxrss;
+#endif
+}
+
+//Simulates one configuration over the whole trace; returns 0 on success
+static int benchRun(char *filename, benchResult *result){
+    cacheModel model;
+    const cacheConfig *config = &result->config;
+    if (modelInit(&model, config->size, config->ways, config->line, config->replacementPolicy)){
+        return -1;
+    }
+    modelSeed(&model, config->seed);
+    if (modelSetPrefetcher(&model, config->prefetcher, config->prefetchDegree)
+        || modelSetWritePolicy(&model, config->writePolicy, config->writeAllocate, config->writeBufferEntries)
+        || modelSetVictimCache(&model, config->victimEntries)
+        || modelSetWayPredictor(&model, config->wayPredictor)
+        || traceOpen(filename)){
+        modelFree(&model);
+        return -1;
+    }
+
+    traceRecord *batch = malloc(sizeof(traceRecord) * TRACE_BATCH_SIZE);
+    uint8_t *outcomes = malloc(sizeof(uint8_t) * TRACE_BATCH_SIZE);
+    result->parseSeconds = 0;
+    result->simulateSeconds = 0;
+    for (;;){
+        double start = benchNow();
+        uint32_t numRead = traceReadBatch(batch, TRACE_BATCH_SIZE);
+        double parsed = benchNow();
+        result->parseSeconds += parsed - start;
+        if (numRead == 0){
+            break;
+        }
+        modelAccessBatch(&model, batch, numRead, outcomes);
+        result->simulateSeconds += benchNow() - parsed;
+    }
+    free(batch);
+    free(outcomes);
+    traceClose();
+
+    result->accesses = model.numAccesses;
+    result->misses = model.totalMisses;
+    result->peakRssKB = benchPeakRss();
+    modelFree(&model);
+    return 0;
+}
+
+//"size:ways:line:policy" label for a configuration
+static void benchLabel(const cacheConfig *config, char *label, size_t length){
+    snprintf(label, length, "%u:%u:%u:%s", config->size, config->ways, config->line, modelPolicyName(config->replacementPolicy));
+}
+
+static void benchWriteResults(FILE *file, const char *filename, const benchResult *results, uint32_t numResults, int csv){
+    char label[64];
+    if (csv){
+        fprintf(file, "trace,config,accesses,misses,parse_s,simulate_s,ns_per_access,simulate_ns_per_access,accesses_per_s,peak_rss_kb\n");
+    } else {
+        fprintf(file, "{\n  \"trace\": \"%s\",\n  \"results\": [\n", filename);
+    }
+    for (uint32_t r = 0; r < numResults; r++){
+        const benchResult *result = &results[r];
+        double total = result->parseSeconds + result->simulateSeconds;
+        double accesses = result->accesses ? (double) result->accesses : 1;
+        benchLabel(&result->config, label, sizeof(label));
+        if (csv){
+            fprintf(file, "%s,%s,%llu,%llu,%.6f,%.6f,%.3f,%.3f,%.0f,%ld\n", filename, label,
+                (unsigned long long) result->accesses, (unsigned long long) result->misses,
+                result->parseSeconds, result->simulateSeconds, total * 1e9 / accesses,
+                result->simulateSeconds * 1e9 / accesses, total > 0 ? result->accesses / total : 0, result->peakRssKB);
+        } else {
+            fprintf(file, "    {\"config\": \"%s\", \"accesses\": %llu, \"misses\": %llu, \"parse_s\": %.6f, \"simulate_s\": %.6f, "
+                "\"ns_per_access\": %.3f, \"simulate_ns_per_access\": %.3f, \"accesses_per_s\": %.0f, \"peak_rss_kb\": %ld}%s\n",
+                label, (unsigned long long) result->accesses, (unsigned long long) result->misses,
+                result->parseSeconds, result->simulateSeconds, total * 1e9 / accesses,
+                result->simulateSeconds * 1e9 / accesses, total > 0 ? result->accesses / total : 0, result->peakRssKB,
+                r + 1 < numResults ? "," : "");
+        }
+    }
+    if (!csv){
+        fprintf(file, "  ]\n}\n");
+    }
+}
+
+/////////////////////////////////////////////////////
+// runBench: benchmarks the given configurations, or
+// the built-in suite if there are none
+/////////////////////////////////////////////////////
+
+int runBench(char *filename, const cacheConfig *configs, uint32_t numConfigs, char *resultsFilename){
+    uint32_t numResults = numConfigs ? numConfigs : BENCH_SUITE_SIZE;
+    benchResult *results = malloc(sizeof(benchResult) * numResults);
+    for (uint32_t r = 0; r < numResults; r++){
+        if (numConfigs){
+            results[r].config = configs[r];
+        } else {
+            configParse(benchSuite[r], &results[r].config, 0);
+        }
+    }
+
+    char label[64];
+    printf("%-20s %12s %10s %10s %12s %12s %14s\n", "Config", "Accesses", "Parse s", "Sim s",
+        "ns/access", "Sim ns/acc", "Accesses/s");
+    for (uint32_t r = 0; r < numResults; r++){
+        benchResult *result = &results[r];
+        benchLabel(&result->config, label, sizeof(label));
+        if (benchRun(filename, result)){
+            printf("Could not benchmark %s\n", label);
+            free(results);
+            return -1;
+        }
+        double total = result->parseSeconds + result->simulateSeconds;
+        double accesses = result->accesses ? (double) result->accesses : 1;
+        printf("%-20s %12llu %10.3f %10.3f %12.2f %12.2f %14.0f\n", label, (unsigned long long) result->accesses,
+            result->parseSeconds, result->simulateSeconds, total * 1e9 / accesses,
+            result->simulateSeconds * 1e9 / accesses, total > 0 ? result->accesses / total : 0);
+    }
+    printf("Peak RSS: %ld KB\n", benchPeakRss());
+
+    FILE *file = fopen(resultsFilename, "w");
+    if (file == NULL){
+        printf("Could not open %s\n", resultsFilename);
+        free(results);
+        return -1;
+    }
+    size_t length = strlen(resultsFilename);
+    benchWriteResults(file, filename, results, numResults, length >= 4 && !strcmp(resultsFilename + length - 4, ".csv"));
+    fclose(file);
+
+    free(results);
+    return 0;
+}
+
+/////////////////////////////////////////////////////
+// End of file
+/////////////////////////////////////////////////////
@@ -0,0 +1,21 @@
+/////////////////////////////////////////////////////
+// CSC 252 Project 4
+// Cache Simulator
+// Wilfred Wallis and Chris Dalke
+/////////////////////////////////////////////////////
+// File: bench.h
+/////////////////////////////////////////////////////
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdint.h>
+#include "multi.h"
+
+int runBench(char *filename, const cacheConfig *configs, uint32_t numConfigs, char *resultsFilename);
+
+#endif
+
+/////////////////////////////////////////////////////
+// End of file
+/////////////////////////////////////////////////////
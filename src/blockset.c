@@ -0,0 +1,147 @@
+/////////////////////////////////////////////////////
+// CSC 252 Project 4
+// Cache Simulator
+// Wilfred Wallis and Chris Dalke
+/////////////////////////////////////////////////////
+// File: blockset.c
+/////////////////////////////////////////////////////
+
+#include <stdlib.h>
+#include "blockset.h"
+
+/////////////////////////////////////////////////////
+// Sparse first-touch tracker
+//
+// Compulsory misses need to know whether a block has
+// ever been loaded. Rather than one bit for every block
+// in the address space, bits live in small pages that
+// are allocated the first time a block in their range is
+// touched. Pages are found through an open-addressing
+// hash table keyed by page number, so memory follows
+// the trace's footprint and works for any address width.
+/////////////////////////////////////////////////////
+
+#define BLOCKSET_INITIAL_SLOTS 64
+
+static inline uint64_t blockSetHash(uint64_t pageNumber){
+    return pageNumber * 0x9E3779B97F4A7C15ull;
+}
+
+//Finds the slot for a page, empty if the page is not allocated
+static blockPage *blockSetFind(blockPage *pages, uint64_t mask, uint64_t pageNumber){
+    uint64_t slot = (blockSetHash(pageNumber) >> 32) & mask;
+    while (pages[slot].bits != NULL && pages[slot].pageNumber != pageNumber){
+        slot = (slot + 1) & mask;
+    }
+    return &pages[slot];
+}
+
+//Doubles the page table
+static int blockSetGrow(blockSet *bs){
+    uint64_t newMask = bs->mask * 2 + 1;
+    blockPage *pages = calloc(newMask + 1, sizeof(blockPage));
+    if (pages == NULL){
+        return -1;
+    }
+    for (uint64_t slot = 0; slot <= bs->mask; slot++){
+        if (bs->pages[slot].bits != NULL){
+            *blockSetFind(pages, newMask, bs->pages[slot].pageNumber) = bs->pages[slot];
+        }
+    }
+    free(bs->pages);
+    bs->pages = pages;
+    bs->mask = newMask;
+    bs->lastPage = NULL;
+    return 0;
+}
+
+int blockSetInit(blockSet *bs){
+    bs->pages = calloc(BLOCKSET_INITIAL_SLOTS, sizeof(blockPage));
+    bs->mask = BLOCKSET_INITIAL_SLOTS - 1;
+    bs->numPages = 0;
+    bs->lastPage = NULL;
+    bs->numBlocks = 0;
+    return bs->pages == NULL ? -1 : 0;
+}
+
+//Marks a block as touched
+//Returns 1 if this is its first touch, 0 if it was seen before
+uint32_t blockSetInsert(blockSet *bs, uint64_t block){
+    uint64_t pageNumber = block >> BLOCKSET_PAGE_BITS;
+    blockPage *page = bs->lastPage;
+
+    if (page == NULL || page->pageNumber != pageNumber){
+        page = blockSetFind(bs->pages, bs->mask, pageNumber);
+        if (page->bits == NULL){
+            //Keep the table at most half full
+            if ((bs->numPages + 1) * 2 > bs->mask + 1){
+                if (blockSetGrow(bs)){
+                    abort();
+                }
+                page = blockSetFind(bs->pages, bs->mask, pageNumber);
+            }
+            page->pageNumber = pageNumber;
+            page->bits = calloc(BLOCKSET_PAGE_WORDS, sizeof(uint64_t));
+            if (page->bits == NULL){
+                abort();
+            }
+            bs->numPages++;
+        }
+        bs->lastPage = page;
+    }
+
+    uint64_t offset = block & ((1 << BLOCKSET_PAGE_BITS) - 1);
+    uint64_t bit = (uint64_t)1 << (offset % 64);
+    uint64_t *word = &page->bits[offset / 64];
+    if (*word & bit){
+        return 0;
+    }
+    *word |= bit;
+    bs->numBlocks++;
+    return 1;
+}
+
+//Saves every allocated page; returns 0 on success
+int blockSetWrite(const blockSet *bs, FILE *file){
+    int failed = fwrite(&bs->numBlocks, sizeof(bs->numBlocks), 1, file) != 1
+              || fwrite(&bs->numPages, sizeof(bs->numPages), 1, file) != 1;
+    for (uint64_t slot = 0; slot <= bs->mask && !failed; slot++){
+        if (bs->pages[slot].bits != NULL){
+            failed = fwrite(&bs->pages[slot].pageNumber, sizeof(uint64_t), 1, file) != 1
+                  || fwrite(bs->pages[slot].bits, sizeof(uint64_t), BLOCKSET_PAGE_WORDS, file) != BLOCKSET_PAGE_WORDS;
+        }
+    }
+    return failed ? -1 : 0;
+}
+
+//Loads blockSetWrite's output into an empty set; returns 0 on success
+int blockSetRead(blockSet *bs, FILE *file){
+    uint64_t numBlocks, numPages;
+    if (fread(&numBlocks, sizeof(numBlocks), 1, file) != 1 || fread(&numPages, sizeof(numPages), 1, file) != 1){
+        return -1;
+    }
+    for (uint64_t p = 0; p < numPages; p++){
+        uint64_t pageNumber;
+        if (fread(&pageNumber, sizeof(pageNumber), 1, file) != 1){
+            return -1;
+        }
+        //Touching the page's first block allocates it; then the bits are replaced
+        blockSetInsert(bs, pageNumber << BLOCKSET_PAGE_BITS);
+        if (fread(bs->lastPage->bits, sizeof(uint64_t), BLOCKSET_PAGE_WORDS, file) != BLOCKSET_PAGE_WORDS){
+            return -1;
+        }
+    }
+    bs->numBlocks = numBlocks;
+    return 0;
+}
+
+void blockSetFree(blockSet *bs){
+    for (uint64_t slot = 0; slot <= bs->mask; slot++){
+        free(bs->pages[slot].bits);
+    }
+    free(bs->pages);
+}
+
+/////////////////////////////////////////////////////
+// End of file
+/////////////////////////////////////////////////////
@@ -0,0 +1,43 @@
+/////////////////////////////////////////////////////
+// CSC 252 Project 4
+// Cache Simulator
+// Wilfred Wallis and Chris Dalke
+/////////////////////////////////////////////////////
+// File: blockset.h
+/////////////////////////////////////////////////////
+
+#ifndef BLOCKSET_H
+#define BLOCKSET_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+//Each page is a bitmap covering 2^BLOCKSET_PAGE_BITS consecutive blocks
+#define BLOCKSET_PAGE_BITS 12
+#define BLOCKSET_PAGE_WORDS ((1 << BLOCKSET_PAGE_BITS) / 64)
+
+typedef struct {
+    uint64_t pageNumber; //block >> BLOCKSET_PAGE_BITS
+    uint64_t *bits;      //NULL for an empty slot
+} blockPage;
+
+//Set of block numbers that have been touched at least once
+typedef struct {
+    blockPage *pages;    //open-addressing table of allocated pages
+    uint64_t mask;       //table size - 1
+    uint64_t numPages;
+    blockPage *lastPage; //page of the previous insert, for locality
+    uint64_t numBlocks;  //unique blocks seen (working-set size)
+} blockSet;
+
+int blockSetInit(blockSet *bs);
+uint32_t blockSetInsert(blockSet *bs, uint64_t block);
+int blockSetWrite(const blockSet *bs, FILE *file);
+int blockSetRead(blockSet *bs, FILE *file);
+void blockSetFree(blockSet *bs);
+
+#endif
+
+/////////////////////////////////////////////////////
+// End of file
+/////////////////////////////////////////////////////
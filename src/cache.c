@@ -8,20 +8,19 @@
 
 #include "cache.h"
 #include "trace.h"
-
-//Define constants
-//Hit/miss constants
-#define HIT_SUCCESS 0
-#define CONFLICT_MISS 1
-#define COMPULSORY_MISS 2
-#define CAPACITY_MISS 3
-#define UNKNOWN_MISS 4
-//Replacement policies
-#define FIFO 0
-#define LRU 1
-
-int write_xactions = 0;
-int read_xactions = 0;
+#include "model.h"
+#include "sweep.h"
+#include "multi.h"
+#include "pool.h"
+#include "hierarchy.h"
+#include "sample.h"
+#include "coherence.h"
+#include "shard.h"
+#include "pipeline.h"
+#include "generate.h"
+#include "bench.h"
+#include "profile.h"
+#include "run.h"
 
 /////////////////////////////////////////////////////
 // printHelp function: Prints help message to user
@@ -34,8 +33,40 @@ void printHelp(const char * prog) {
     printf("-s <cache size>: set the total size of the cache in KB\n");
     printf("-w <ways>: set the number of ways in each set\n");
     printf("-l <line size>: set the size of each cache line in bytes\n");
-    printf("-t <trace>: use <trace> as the input file for memory traces\n");
+    printf("-t <trace>: use <trace> as the input file for memory traces (\"-\" for stdin, \"shm:/name\" for a shared-memory ring)\n");
     printf("-lru: use LRU replacement policy instead of FIFO\n"); //Extra credit parameter
+    printf("-policy <fifo|lru|plru|srrip|brrip|drrip|random>: choose the replacement policy\n");
+    printf("-seed <n>: seed for the random and BRRIP/DRRIP policies and the sets -sample picks\n");
+    printf("-sweep: report LRU miss rates for every power-of-two size in one pass\n");
+    printf("-sample <n>: simulate about 1 in n sets and estimate the results with 95%% confidence intervals\n");
+    printf("-cores <n>: simulate a multi-core trace (\"l|s 0x<address> <core>\") with one private cache per core and MESI coherence\n");
+    printf("-prefetch <none|nextline|stride|stream>: prefetch into the cache (or stream buffers) and report accuracy, coverage and traffic\n");
+    printf("-prefetch-degree <n>: blocks fetched ahead, or stream buffer depth (default 1 / 2 / 4, at most %d)\n", PREFETCH_MAX_DEGREE);
+    printf("-write-through: send every store on to memory instead of dirtying the line (default write-back)\n");
+    printf("-no-write-allocate: store misses write around the cache instead of filling the line\n");
+    printf("-write-buffer <n>: coalesce writes to memory in an n-entry buffer (at most %d)\n", WRITEBUF_MAX_ENTRIES);
+    printf("-victim <n>: put an n-entry fully associative victim cache behind the cache (at most %d)\n", VICTIM_MAX_ENTRIES);
+    printf("-way-predict <mru|hash>: predict the way before the tag check and count the tag comparisons saved\n");
+    printf("-c <size:ways:line[:policy][:seed=n][:prefetcher][:degree=n][:writethrough][:noallocate][:wbuf=n][:victim=n][:waypredict=p]>: add a configuration to simulate in parallel (repeatable)\n");
+    printf("-configs <file>: read configurations, one \"size ways line [options]\" per line\n");
+    printf("-L <size:ways:line[:policy][:seed=n][:nine|inclusive|exclusive]>: add a level to a cache hierarchy, L1 first (repeatable)\n");
+    printf("-hierarchy <file>: read hierarchy levels, one \"size ways line [options]\" per line, L1 first\n");
+    printf("-j <threads>: number of worker threads for -c / -configs; for a single cache, split its sets over the threads\n");
+    printf("-o <text|binary|none>: per-access output: .simulated text, 2-bit .outcomes, or nothing\n");
+    printf("-simd <auto|scalar|sse2|avx2>: limit the instruction set used to search sets\n");
+    printf("-pipeline <auto|on|off>: parse, simulate and write on separate threads (auto: when there is more than one processor)\n");
+    printf("-export <stats.json|stats.csv>: write per-set counts, reuse distances and interval miss rates\n");
+    printf("-interval <n>: accesses per miss rate sample for -export (default %d)\n", PROFILE_DEFAULT_INTERVAL);
+    printf("-reuse-sample <n>: follow 1 in n blocks for reuse distances in -export (default %d, 1 is exact)\n", PROFILE_DEFAULT_SAMPLE);
+    printf("-checkpoint <n> <file>: save the whole cache state after n accesses, then carry on\n");
+    printf("-restore <file>: resume from a checkpoint of the same configuration, skipping the accesses it covers\n");
+    printf("-fast-forward <n>: simulate n accesses to warm the cache, then start the statistics and output\n");
+    printf("-live <n>: print throughput, miss rate and the 3C split to stderr every n accesses while running\n");
+    printf("-coalesce: group back-to-back accesses to one block and simulate each group at once (same results)\n");
+    printf("-stats: print additional statistics after the results\n");
+    printf("-convert <output>: convert the trace to the compact binary format and exit\n");
+    printf("-generate <stream|stride|random|chase|zipf[:count=n][:footprint=bytes][:stride=bytes][:alpha=x][:stores=pct]> <output>: write a synthetic binary trace (\"-\" for stdout, \"shm:/name\" to feed a ring) and exit\n");
+    printf("-bench <results.json|results.csv>: time the built-in suite (or the -c / -configs configurations) over the trace\n");
 }
 
 /////////////////////////////////////////////////////
@@ -60,14 +91,47 @@ int main(int argc, char* argv[])
     uint32_t ways = 1; //# of ways in L1. Default to direct-mapped
     uint32_t line = 32; //line size (B)
     uint32_t replacementPolicy = FIFO; //replacement policy
+    uint64_t seed = 1; //seed for the randomized policies
+    uint32_t sweepMode = 0; //run the single-pass size sweep instead of one simulation
+    uint32_t sampleRatio = 0; //simulate 1 in this many sets, if set
+    uint32_t numCores = 0; //simulate this many coherent private caches, if set
+    uint32_t outputMode = OUTPUT_TEXT; //what to write per access
+    char * convertFilename = NULL; //binary trace to write instead of simulating
+    char * generateSpecText = NULL; //synthetic trace to generate instead of simulating
+    char * generateFilename = NULL;
+    char * benchFilename = NULL; //benchmark results to write instead of simulating
+    uint32_t extraStats = 0; //print statistics beyond the GOLD format
+    uint32_t prefetchKind = PREFETCH_NONE; //prefetcher for the single cache
+    uint32_t prefetchDegree = 0; //0 for the prefetcher's default
+    uint32_t writePolicy = WRITE_BACK; //what a store hit does
+    uint32_t writeAllocate = 1; //whether a store miss fills the line
+    uint32_t writeBufferEntries = 0; //0 for no write buffer
+    uint32_t victimEntries = 0; //0 for no victim cache
+    uint32_t wayPredictor = WAYPRED_NONE; //way predictor for the single cache
+    uint32_t coalesce = 0; //simulate runs of accesses to one block as groups
+    uint32_t pipelineMode = PIPELINE_AUTO; //whether reading and writing overlap the simulation
+    char * exportFilename = NULL; //detailed statistics file, if any
+    uint32_t exportInterval = PROFILE_DEFAULT_INTERVAL;
+    uint32_t reuseSample = PROFILE_DEFAULT_SAMPLE;
+    uint64_t fastForward = 0; //accesses simulated before statistics start
+    char * checkpointFilename = NULL; //state to save part way through, if any
+    uint64_t checkpointAt = 0;
+    char * restoreFilename = NULL; //state to resume from, if any
+    uint64_t liveInterval = 0; //accesses per rolling report, if any
     int i;
 
-    // hit and miss counts
-    int totalHits = 0;
-    int totalMisses = 0;
+    //Configurations to simulate in parallel, if any
+    cacheConfig * configs = NULL;
+    uint32_t numConfigs = 0;
+    uint32_t numThreads = poolDefaultThreads();
+    uint32_t threadsGiven = 0; //-j was given, so a single cache is sharded
+
+    //Levels of a multi-level hierarchy, if any
+    cacheConfig * levels = NULL;
+    uint32_t numLevels = 0;
 
     //Filename for the cache simulation we want to load
-    char * filename;
+    char * filename = NULL;
 
     //Command line arguments to compare to
     const char helpString[] = "-h";
@@ -76,6 +140,38 @@ int main(int argc, char* argv[])
     const char lineString[] = "-l";
     const char traceString[] = "-t";
     const char lruString[] = "-lru";
+    const char policyString[] = "-policy";
+    const char seedString[] = "-seed";
+    const char sweepString[] = "-sweep";
+    const char sampleString[] = "-sample";
+    const char coresString[] = "-cores";
+    const char configString[] = "-c";
+    const char configFileString[] = "-configs";
+    const char threadsString[] = "-j";
+    const char levelString[] = "-L";
+    const char hierarchyString[] = "-hierarchy";
+    const char outputString[] = "-o";
+    const char convertString[] = "-convert";
+    const char generateString[] = "-generate";
+    const char benchString[] = "-bench";
+    const char statsString[] = "-stats";
+    const char simdString[] = "-simd";
+    const char pipelineString[] = "-pipeline";
+    const char exportString[] = "-export";
+    const char prefetchString[] = "-prefetch";
+    const char prefetchDegreeString[] = "-prefetch-degree";
+    const char writeThroughString[] = "-write-through";
+    const char noWriteAllocateString[] = "-no-write-allocate";
+    const char writeBufferString[] = "-write-buffer";
+    const char victimString[] = "-victim";
+    const char wayPredictString[] = "-way-predict";
+    const char coalesceString[] = "-coalesce";
+    const char intervalString[] = "-interval";
+    const char reuseSampleString[] = "-reuse-sample";
+    const char checkpointString[] = "-checkpoint";
+    const char restoreString[] = "-restore";
+    const char fastForwardString[] = "-fast-forward";
+    const char liveString[] = "-live";
 
     if (argc == 1) {
     // No arguments passed, show help
@@ -145,441 +241,424 @@ int main(int argc, char* argv[])
             replacementPolicy = LRU;
         }
 
-        //unrecognized input
-        else {
-            printf("Unrecognized argument. Exiting.\n");
-            return -1;
+        else if (!strcmp(policyString, argv[i])){
+            //Use any of the replacement policies by name
+            i++;
+            int policy = i < argc ? modelPolicyParse(argv[i]) : -1;
+            if (policy >= 0){
+                replacementPolicy = policy;
+            } else {
+                printf("Unrecognized replacement policy\n");
+                return -1; //input failure
+            }
         }
-    }
-
-    /////////////////////////////////////////////////////
-    // Main Cache Initialization
-    /////////////////////////////////////////////////////
-
-    //Calculate the cache attributes
-    uint32_t numSets = (size * 1024) / (line * ways);
-    uint32_t numIndexBits = logBaseTwo(numSets);
-    uint32_t numOffsetBits = logBaseTwo(line);
-    uint32_t numTagBits = (32) - (numIndexBits + numOffsetBits);
-
-    //Setup tag array
-    //Setup valid bit array
-    //Setup dirty bit array
-    uint32_t tagArray[numSets][ways];
-    uint32_t validBit[numSets][ways];
-    uint32_t dirtyBit[numSets][ways];
-    uint32_t evictionTable[numSets][ways];
-
-    //Initialize compulsory flag array
-    uint32_t compulsoryFlagsNum = ((int)pow(2,numTagBits + numIndexBits)) / 32;
-    uint32_t *compulsoryFlags;
-    compulsoryFlags = (uint32_t *)malloc(sizeof(uint32_t) * (compulsoryFlagsNum));
-    for (uint32_t i = 0; i < compulsoryFlagsNum; i++){
-        resetBit(compulsoryFlags,i);
-    }
 
-    //initialize the arrays to default values
-    for (int currentSet = 0; currentSet < numSets; currentSet++){
-        for (int currentWay = 0; currentWay < ways; currentWay++){
-            tagArray[currentSet][currentWay] = 0;
-            validBit[currentSet][currentWay] = 0;
-            dirtyBit[currentSet][currentWay] = 0;
-            evictionTable[currentSet][currentWay] = 0;
+        else if (!strcmp(seedString, argv[i])){
+            i++;
+            if (i < argc && isdigit(argv[i][0])){
+                seed = strtoull(argv[i], NULL, 10);
+            } else {
+                printf("Incorrect formatting of seed\n");
+                return -1; //input failure
+            }
         }
-    }
 
-    /////////////////////////////////////////////////////
-    // Fully-Associative Cache Initialization
-    /////////////////////////////////////////////////////
-
-    //Initialize fully associative cache simulation
-    //We use this to detect conflict vs capacity misses
-    uint32_t fullyAssocNumWays = (size * 1024) / (line); //figure out the number of ways we need such that numSets = 1;
-    uint32_t fullyAssocNumSets = (size * 1024) / (line * fullyAssocNumWays); //This should be equal to one
-    assert(fullyAssocNumSets == 1);
-    uint32_t fullyAssocNumIndexBits = logBaseTwo(fullyAssocNumSets);
-    uint32_t fullyAssocNumOffsetBits = logBaseTwo(line);
-    uint32_t fullyAssocNumTagBits = (32) - (fullyAssocNumIndexBits + fullyAssocNumOffsetBits);
-
-    //Initialize fully associative arrays
-    uint32_t fullyAssocTagArray[fullyAssocNumWays];
-    uint32_t fullyAssocValidBit[fullyAssocNumWays];
-    uint32_t fullyAssocDirtyBit[fullyAssocNumWays];
-    uint32_t fullyAssocEvictionTable[fullyAssocNumWays];
-
-    //Initialize fully associative arrays to default values
-    for (int fullyAssocCurrentWay = 0; fullyAssocCurrentWay < fullyAssocNumWays; fullyAssocCurrentWay++){
-        fullyAssocTagArray[fullyAssocCurrentWay] = 0;
-        fullyAssocValidBit[fullyAssocCurrentWay] = 0;
-        fullyAssocDirtyBit[fullyAssocCurrentWay] = 0;
-        fullyAssocEvictionTable[fullyAssocCurrentWay] = 0;
-    }
-
-    /////////////////////////////////////////////////////
-    // Program Output
-    /////////////////////////////////////////////////////
-
-    //Print out the parameters we grabbed for the cache
-    printf("Ways: %u; Sets: %u; Line Size: %uB\n", ways,numSets,line);
-    printf("Tag: %d bits; Index: %d bits; Offset: %d bits\n", numTagBits, numIndexBits, numOffsetBits);
-
-    /////////////////////////////////////////////////////
-    // Output File Initialization
-    // Result files will be stored in the trace folder
-    /////////////////////////////////////////////////////
-
-    //Name the filename based on the input file
-    //Allocate a string big enough for the appended filename and add extension
-    char * outputFilename = malloc( sizeof(char) * ( strlen(filename) + 16 ) );
-    strcpy(outputFilename,filename);
-    strcat(outputFilename,".simulated");
-
-    //Open the output file stream
-    //We will write to this file later
-    outputOpen(outputFilename);
-
-    //Set up output labels
-    char * cacheHitTag = " hit\n";
-    char * compulsoryMissTag = " compulsory\n";
-    char * capacityMissTag = " capacity\n";
-    char * conflictMissTag = " conflict\n";
-
-    /////////////////////////////////////////////////////
-    // Input File Initialization
-    /////////////////////////////////////////////////////
-
-    //Load the input file
-    traceOpen(filename);
-
-    /////////////////////////////////////////////////////
-    // Cache Simulation Loop
-    /////////////////////////////////////////////////////
+        else if (!strcmp(sweepString, argv[i])){
+            //Sweep all cache sizes using the line size and set count given
+            sweepMode = 1;
+        }
 
-    //Temporary utility variables
-    int numReadLines = 0;
-    char * currentOutput;
-    char tempAccessType;
-    char * tempAddress = malloc( sizeof(char) * (12));
-    uint32_t currentAddress;
-    char * statusTag;
-
-    //Read in the file, line by line
-    char * nextLine = traceReadLine();
-    while (nextLine != NULL){
-        numReadLines++;
-
-        /////////////////////////////////////////////////////
-        // Instruction Data Parsing / Setup
-        /////////////////////////////////////////////////////
-
-        //Get the access type
-        tempAccessType = nextLine[0];
-
-        //Get the address of the access by getting character 2 to 10 in the input line
-        strncpy(tempAddress,nextLine + 2,10);
-        //manually add null terminator to end the string
-        tempAddress[10] = '\0'; 
-        //Convert hex address to integer address
-        currentAddress = strtol(tempAddress, NULL, 0);
-
-        //Get the index, tag, and offset bits
-        uint32_t tagBits = extractBitSequence(currentAddress,32-numTagBits,numTagBits);
-        uint32_t indexBits = extractBitSequence(currentAddress,numOffsetBits,numIndexBits);
-        uint32_t offsetBits = extractBitSequence(currentAddress,0,numOffsetBits);
-
-        //Get the address (index + tag bits) and cut off the offset bits
-        //Since offset bits are within a data block, we just need to see if the block has loaded
-        uint32_t currentDataBlock = extractBitSequence(currentAddress,numOffsetBits,32-numOffsetBits);
-
-        //Convert this to the set number / slot number
-        uint32_t slotId = indexBits;
-
-        //Store result cache location after we find the slot we would like to use
-        uint32_t selectedWay;
-
-        //Store Hit / miss status
-        uint32_t hitStatus = UNKNOWN_MISS;
-
-        /////////////////////////////////////////////////////
-        // Cache Search
-        /////////////////////////////////////////////////////
-
-        //Loop through the cache and search for a valid entry
-        for (int currentWay = 0; currentWay < ways; currentWay++){
-            if (validBit[indexBits][currentWay] == 1){
-                if (tagArray[indexBits][currentWay] == tagBits){
-                    //Mark this as a successful hit
-                    hitStatus = HIT_SUCCESS;
-                    selectedWay = currentWay;
-                    break;
-                } else {
-                    //This might be a miss, but no idea what type of miss it is yet.
-                    //We will determine it later
-                    hitStatus = UNKNOWN_MISS;
-                }
+        else if (!strcmp(sampleString, argv[i])){
+            //Estimate from a subset of the sets
+            i++;
+            if (i < argc && isdigit(argv[i][0]) && atoi(argv[i]) > 1){
+                sampleRatio = atoi(argv[i]);
+            } else {
+                printf("Incorrect formatting of sampling ratio\n");
+                return -1; //input failure
             }
         }
 
+        else if (!strcmp(coresString, argv[i])){
+            i++;
+            if (i < argc && isdigit(argv[i][0]) && atoi(argv[i]) > 0 && atoi(argv[i]) <= COHERENCE_MAX_CORES){
+                numCores = atoi(argv[i]);
+            } else {
+                printf("Incorrect formatting of core count (1 to %d)\n", COHERENCE_MAX_CORES);
+                return -1; //input failure
+            }
+        }
 
-        /////////////////////////////////////////////////////
-        // Fully Associative Cache Simulation
-        /////////////////////////////////////////////////////
-        //Check if the fully associative cache had a hit or miss
-        //If it had a miss, quickly add the values to the fully-associative table
-        //If it had a hit, update the fully associative eviction table
-        // We do all the fully associative simulation in this section
+        else if (!strcmp(configString, argv[i])){
+            //Add one configuration to the parallel run
+            configs = realloc(configs, sizeof(cacheConfig) * (numConfigs + 1));
+            if (i + 1 < argc && !configParse(argv[++i], &configs[numConfigs], 0)){
+                numConfigs++;
+            } else {
+                printf("Incorrect formatting of configuration\n");
+                return -1; //input failure
+            }
+        }
 
-        //START FULLY ASSOCIATIVE SIMULATION
+        else if (!strcmp(configFileString, argv[i])){
+            //Add every configuration listed in a file
+            if (i + 1 >= argc || configLoadFile(argv[++i], &configs, &numConfigs, 0)){
+                printf("Could not read configuration file\n");
+                return -1; //input failure
+            }
+        }
 
-        uint32_t fullyAssocHitStatus = UNKNOWN_MISS;
-        uint32_t fullyAssocSelectedWay = 0;
+        else if (!strcmp(levelString, argv[i])){
+            //Add the next level below those already given
+            levels = realloc(levels, sizeof(cacheConfig) * (numLevels + 1));
+            if (i + 1 < argc && !configParse(argv[++i], &levels[numLevels], 1)){
+                numLevels++;
+            } else {
+                printf("Incorrect formatting of hierarchy level\n");
+                return -1; //input failure
+            }
+        }
 
-        for (int fullyAssocCurrentWay = 0; fullyAssocCurrentWay < fullyAssocNumWays; fullyAssocCurrentWay++){
-            if (fullyAssocValidBit[fullyAssocCurrentWay] == 1){
-                if (fullyAssocTagArray[fullyAssocCurrentWay] == currentDataBlock){
-                    fullyAssocHitStatus = HIT_SUCCESS;
-                    fullyAssocSelectedWay = fullyAssocCurrentWay;
-                    break;
-                } else {
-                    fullyAssocHitStatus = UNKNOWN_MISS;
-                }
+        else if (!strcmp(hierarchyString, argv[i])){
+            //Add every level listed in a file
+            if (i + 1 >= argc || configLoadFile(argv[++i], &levels, &numLevels, 1)){
+                printf("Could not read hierarchy file\n");
+                return -1; //input failure
             }
         }
 
-        if (fullyAssocHitStatus == HIT_SUCCESS){
+        else if (!strcmp(threadsString, argv[i])){
+            i++;
+            if (i < argc && isdigit(argv[i][0]) && atoi(argv[i]) > 0){
+                numThreads = atoi(argv[i]);
+                threadsGiven = 1;
+            } else {
+                printf("Incorrect formatting of thread count\n");
+                return -1; //input failure
+            }
+        }
 
-            //Update eviction table for this item
-            if (replacementPolicy == LRU){
-                fullyAssocEvictionTable[fullyAssocSelectedWay] = numReadLines; //Use line number as age
+        else if (!strcmp(outputString, argv[i])){
+            //Choose what gets written per access
+            i++;
+            if (i < argc && !strcmp(argv[i], "text")){
+                outputMode = OUTPUT_TEXT;
+            } else if (i < argc && !strcmp(argv[i], "binary")){
+                outputMode = OUTPUT_BINARY;
+            } else if (i < argc && !strcmp(argv[i], "none")){
+                outputMode = OUTPUT_NONE;
+            } else {
+                printf("Unrecognized output mode\n");
+                return -1; //input failure
             }
+        }
 
-        } else {
+        else if (!strcmp(convertString, argv[i])){
+            //Convert the trace instead of simulating it
+            if (i + 1 < argc){
+                convertFilename = argv[++i];
+            } else {
+                printf("Missing output file for -convert\n");
+                return -1; //input failure
+            }
+        }
 
-            //Determine which item to evict
-            uint32_t lowestAge = numReadLines + 1; //start with current age+1 as lowest age
+        else if (!strcmp(generateString, argv[i])){
+            //Generate a trace instead of simulating one
+            if (i + 2 < argc){
+                generateSpecText = argv[++i];
+                generateFilename = argv[++i];
+            } else {
+                printf("Missing pattern or output file for -generate\n");
+                return -1; //input failure
+            }
+        }
 
-            for (int fullyAssocCurrentWay = 0; fullyAssocCurrentWay < fullyAssocNumWays; fullyAssocCurrentWay++){
-                if (fullyAssocEvictionTable[fullyAssocCurrentWay] < lowestAge){
-                    lowestAge = fullyAssocEvictionTable[fullyAssocCurrentWay];
-                    fullyAssocSelectedWay = fullyAssocCurrentWay;
-                }
+        else if (!strcmp(benchString, argv[i])){
+            //Benchmark instead of writing per-access results
+            if (i + 1 < argc){
+                benchFilename = argv[++i];
+            } else {
+                printf("Missing results file for -bench\n");
+                return -1; //input failure
             }
+        }
 
-            //Evict the item, and update the table
-            fullyAssocTagArray[fullyAssocSelectedWay] = currentDataBlock;
-            fullyAssocValidBit[fullyAssocSelectedWay] = 1;
-            fullyAssocDirtyBit[fullyAssocSelectedWay] = 0;
+        else if (!strcmp(simdString, argv[i])){
+            //Applies to every model set up after parsing
+            i++;
+            if (i >= argc || tagStoreSetIsa(argv[i])){
+                printf("Unrecognized instruction set\n");
+                return -1; //input failure
+            }
+        }
 
-            //update eviction table data for our replacement policy
-            fullyAssocEvictionTable[fullyAssocSelectedWay] = numReadLines; //use the line number as an age
+        else if (!strcmp(pipelineString, argv[i])){
+            i++;
+            if (i >= argc || pipelineModeParse(argv[i], &pipelineMode)){
+                printf("Unrecognized pipeline mode\n");
+                return -1; //input failure
+            }
+        }
 
+        else if (!strcmp(prefetchString, argv[i])){
+            i++;
+            int kind = i < argc ? prefetchParse(argv[i]) : -1;
+            if (kind < 0){
+                printf("Unrecognized prefetcher\n");
+                return -1; //input failure
+            }
+            prefetchKind = kind;
         }
 
-        //END FULLY ASSOCIATIVE SIMULATION
+        else if (!strcmp(prefetchDegreeString, argv[i])){
+            i++;
+            if (i >= argc || atoi(argv[i]) <= 0 || atoi(argv[i]) > PREFETCH_MAX_DEGREE){
+                printf("Invalid prefetch degree\n");
+                return -1; //input failure
+            }
+            prefetchDegree = atoi(argv[i]);
+        }
 
-        /////////////////////////////////////////////////////
-        // Hit Handling
-        /////////////////////////////////////////////////////
+        else if (!strcmp(writeThroughString, argv[i])){
+            writePolicy = WRITE_THROUGH;
+        }
 
-        //Based on the hit/miss status, perform whatever action we need to do
-        if (hitStatus == HIT_SUCCESS){
-            //Record the hit
-            totalHits++;
-            //Display the hit
-            statusTag = cacheHitTag;
+        else if (!strcmp(noWriteAllocateString, argv[i])){
+            writeAllocate = 0;
+        }
 
-            //If our replacement policy is LRU
-            //We need to record that we have accessed this cache
-            if (replacementPolicy == LRU){
-                evictionTable[indexBits][selectedWay] = numReadLines; //Use line number as age
-            }
-        } 
-
-        /////////////////////////////////////////////////////
-        // Miss Handling
-        /////////////////////////////////////////////////////
-
-        else if (hitStatus == UNKNOWN_MISS){
-            //Record the miss
-            totalMisses++;
-
-            /////////////////////////////////////////////////////
-            // Replacement Policy Way Selection
-            /////////////////////////////////////////////////////
-            //Choose which item to evict from the current index
-            //We will choose this based on our replacement policy
-            // -FIFO (First In First Out), choose item with lowest age
-            // -LRU (Least Recently Used), choose item with lowest age, update age based on usage
-
-            uint32_t lowestAge = numReadLines + 1; //start with current age+1 as lowest age
-            //Find the lowest age in the table at the current index
-            for (int currentWay = 0; currentWay < ways; currentWay++){
-                if (evictionTable[indexBits][currentWay] < lowestAge){
-                    lowestAge = evictionTable[indexBits][currentWay];
-                    selectedWay = currentWay;
-                }
+        else if (!strcmp(writeBufferString, argv[i])){
+            i++;
+            if (i >= argc || atoi(argv[i]) <= 0 || atoi(argv[i]) > WRITEBUF_MAX_ENTRIES){
+                printf("Invalid write buffer size\n");
+                return -1; //input failure
             }
+            writeBufferEntries = atoi(argv[i]);
+        }
 
-            /////////////////////////////////////////////////////
-            // Miss Type Identification
-            /////////////////////////////////////////////////////
-            //Identify which type of miss occurred
-            //It will be one of the following:
-            //COMPULSORY_MISS: The data address has never been accessed before
-            //CONFLICT_MISS: There was a miss AND the cache is not completely full
-            //CAPACITY_MISS: There was a miss AND the cache is completely full
+        else if (!strcmp(victimString, argv[i])){
+            i++;
+            if (i >= argc || atoi(argv[i]) <= 0 || atoi(argv[i]) > VICTIM_MAX_ENTRIES){
+                printf("Invalid victim cache size\n");
+                return -1; //input failure
+            }
+            victimEntries = atoi(argv[i]);
+        }
 
-            //Compulsory miss occurs if a certain address has never been put into memory
-            //I record this by keeping track of a single 0/1 bit for every single memory address value
-            //I set the bit to 1 if it has been read already, 0 if it has never been read
-            if (getBit(compulsoryFlags,currentDataBlock) == 0){
+        else if (!strcmp(wayPredictString, argv[i])){
+            i++;
+            int kind = i < argc ? waypredParse(argv[i]) : -1;
+            if (kind < 0){
+                printf("Invalid way predictor\n");
+                return -1; //input failure
+            }
+            wayPredictor = kind;
+        }
 
-                //Record the compulsory miss
-                hitStatus = COMPULSORY_MISS;
+        else if (!strcmp(coalesceString, argv[i])){
+            coalesce = 1;
+        }
 
+        else if (!strcmp(exportString, argv[i])){
+            if (i + 1 < argc){
+                exportFilename = argv[++i];
             } else {
-                //If we didn't have a compulsory miss, we could have conflict or capacity miss
-                //Let's check the status of the miss in the fully associative table
-                //If the fully associative table had a HIT, this means this was a conflict miss.
-                //If the fully associative table had a MISS, this was a capacity miss.
-                if (fullyAssocHitStatus == HIT_SUCCESS){
-                    hitStatus = CONFLICT_MISS;
-                } else {
-                    hitStatus = CAPACITY_MISS;
-                }
-
+                printf("Missing file for -export\n");
+                return -1; //input failure
             }
+        }
 
-            //Debug: Make sure we have chosen a miss type
-            assert(hitStatus != UNKNOWN_MISS);
-
-            //Display the miss status
-            switch (hitStatus){
-                case COMPULSORY_MISS: {
-                    statusTag = compulsoryMissTag;
-                    break;
-                }
-                case CONFLICT_MISS: {
-                    statusTag = conflictMissTag;
-                    break;
-                }
-                case CAPACITY_MISS: {
-                    statusTag = capacityMissTag;
-                    break;
-                }
+        else if (!strcmp(intervalString, argv[i])){
+            i++;
+            if (i >= argc || (exportInterval = atoi(argv[i])) <= 0){
+                printf("Invalid interval\n");
+                return -1; //input failure
             }
+        }
 
-            /////////////////////////////////////////////////////
-            // Writeback
-            /////////////////////////////////////////////////////
-
-            if (dirtyBit[indexBits][selectedWay] == 1){
-                //When we evict an old item, if the dirty bit has been set, write it to memory
-                //increment write_xactions to represent this
-                write_xactions++;
+        else if (!strcmp(reuseSampleString, argv[i])){
+            i++;
+            if (i >= argc || (reuseSample = atoi(argv[i])) <= 0){
+                printf("Invalid reuse sampling rate\n");
+                return -1; //input failure
             }
+        }
 
-            /////////////////////////////////////////////////////
-            // Cache Item Update
-            /////////////////////////////////////////////////////
-
-            //update new cache items
-            tagArray[indexBits][selectedWay] = tagBits;
-            validBit[indexBits][selectedWay] = 1;
-            dirtyBit[indexBits][selectedWay] = 0;
+        else if (!strcmp(checkpointString, argv[i])){
+            if (i + 2 >= argc || !isdigit((unsigned char) argv[i + 1][0])){
+                printf("Usage: -checkpoint <accesses> <file>\n");
+                return -1; //input failure
+            }
+            checkpointAt = strtoull(argv[++i], NULL, 10);
+            checkpointFilename = argv[++i];
+        }
 
-            //update eviction table data for our replacement policy
-            evictionTable[indexBits][selectedWay] = numReadLines; //use the line number as an age
+        else if (!strcmp(restoreString, argv[i])){
+            if (i + 1 < argc){
+                restoreFilename = argv[++i];
+            } else {
+                printf("Missing file for -restore\n");
+                return -1; //input failure
+            }
+        }
 
-            //Update compulsory flag table
-            setBit(compulsoryFlags,currentDataBlock);
+        else if (!strcmp(fastForwardString, argv[i])){
+            i++;
+            if (i >= argc || !isdigit((unsigned char) argv[i][0])){
+                printf("Invalid fast-forward count\n");
+                return -1; //input failure
+            }
+            fastForward = strtoull(argv[i], NULL, 10);
+        }
 
-            //Increment 'read from memory' counter
-            read_xactions++;
+        else if (!strcmp(liveString, argv[i])){
+            i++;
+            if (i >= argc || (liveInterval = strtoull(argv[i], NULL, 10)) == 0){
+                printf("Invalid live report interval\n");
+                return -1; //input failure
+            }
         }
 
-        /////////////////////////////////////////////////////
-        // Store Instruction Dirty Bit Handling
-        /////////////////////////////////////////////////////
+        else if (!strcmp(statsString, argv[i])){
+            extraStats = 1;
+        }
 
-        //Handle store instruction
-        if (tempAccessType == 's'){
-            //Set the dirty bit to true for the data we have written to
-            dirtyBit[indexBits][selectedWay] = 1;
+        //unrecognized input
+        else {
+            printf("Unrecognized argument. Exiting.\n");
+            return -1;
         }
+    }
 
-        /////////////////////////////////////////////////////
-        // Output
-        /////////////////////////////////////////////////////
+    /////////////////////////////////////////////////////
+    // Alternate Modes
+    /////////////////////////////////////////////////////
 
-        //Initialize output string
-        currentOutput = malloc( sizeof(char) * ( strlen(nextLine) + 16 ) );
-        //Copy original string into output
-        strcpy(currentOutput,nextLine); 
-        //Remove newline from original input string
-        currentOutput[strlen(currentOutput) - 1] = '\0'; 
-        //Add tag to end of output based on what happened this step
-        strcat(currentOutput,statusTag); 
-        //Write output to file
-        outputWrite(currentOutput);
+    //Other modes take no -prefetch; -c configurations name their own
+    if (prefetchKind != PREFETCH_NONE && (sweepMode || numConfigs || numLevels || numCores || sampleRatio)){
+        fprintf(stderr, "-prefetch only applies to a single cache; ignoring it\n");
+    }
+    uint32_t defaultWrites = writePolicy == WRITE_BACK && writeAllocate && writeBufferEntries == 0;
+    if (!defaultWrites && (sweepMode || numConfigs || numLevels || numCores || sampleRatio || benchFilename != NULL)){
+        fprintf(stderr, "Write policy options only apply to a single cache (-c takes writethrough, noallocate and wbuf=n); ignoring them\n");
+    }
+    uint32_t conflictOptions = victimEntries > 0 || wayPredictor != WAYPRED_NONE;
+    if (conflictOptions && (sweepMode || numConfigs || numLevels || numCores || sampleRatio || benchFilename != NULL)){
+        fprintf(stderr, "-victim and -way-predict only apply to a single cache (-c takes victim=n and waypredict=p); ignoring them\n");
+    }
+    uint32_t resumable = checkpointFilename != NULL || restoreFilename != NULL || fastForward > 0;
+    if (resumable && (sweepMode || numConfigs || numLevels || numCores || sampleRatio || benchFilename != NULL)){
+        fprintf(stderr, "-checkpoint, -restore and -fast-forward only apply to a single cache; ignoring them\n");
+    }
+    if (liveInterval > 0 && (sweepMode || numConfigs || numLevels || numCores || sampleRatio || benchFilename != NULL)){
+        fprintf(stderr, "-live only applies to a single cache; ignoring it\n");
+    }
 
-        //Load the next line, if one exists
-        nextLine = traceReadLine();
+    //Generation writes a trace and needs none
+    if (generateSpecText != NULL){
+        return runGenerate(generateSpecText, generateFilename, seed);
     }
 
-    /////////////////////////////////////////////////////
-    // End of Cache Simulation Loop
-    /////////////////////////////////////////////////////
+    //Everything else reads a trace
+    if (filename == NULL){
+        printf("No trace file given; use -t <trace>\n");
+        return -1; //input failure
+    }
 
-    /* Print results */
-    printf("Miss Rate: %8lf%%\n", ((double) totalMisses) / ((double) totalMisses + (double) totalHits) * 100.0);
-    printf("Read Transactions: %d\n", read_xactions);
-    printf("Write Transactions: %d\n", write_xactions);
+    //Conversion only rewrites the trace
+    if (convertFilename != NULL){
+        return traceConvert(filename, convertFilename);
+    }
 
-    /////////////////////////////////////////////////////
-    // Cleanup
-    /////////////////////////////////////////////////////
+    //Sweep mode replaces the single simulation entirely
+    if (sweepMode){
+        return runSweep(filename, line, (size * 1024) / (line * ways));
+    }
 
-    //Close the trace
-    traceClose();
+    //Benchmark the configurations given, or the built-in suite
+    if (benchFilename != NULL){
+        int result = runBench(filename, configs, numConfigs, benchFilename);
+        free(configs);
+        return result;
+    }
 
-    //Close the output file
-    outputClose();
+    //Simulate every configuration given with -c / -configs in parallel
+    if (numConfigs > 0){
+        int result = runMulti(filename, configs, numConfigs, numThreads, outputMode, extraStats);
+        free(configs);
+        return result;
+    }
 
-}
+    //Simulate the levels given with -L / -hierarchy as one hierarchy
+    if (numLevels > 0){
+        int result = runHierarchy(filename, levels, numLevels, outputMode);
+        free(levels);
+        return result;
+    }
 
-/////////////////////////////////////////////////////
-// Utility Functions
-/////////////////////////////////////////////////////
+    //Multi-core traces get one coherent cache per core
+    if (numCores > 0){
+        return runCoherence(filename, numCores, size, ways, line, replacementPolicy, seed, outputMode);
+    }
 
-//Finds log base 2 of a number
-uint32_t logBaseTwo(uint32_t num){
-    uint32_t r = 0;
-    while (num >>= 1){
-        r++;
+    //Sampling estimates the single simulation from a subset of sets
+    if (sampleRatio > 0){
+        return runSample(filename, size, ways, line, replacementPolicy, seed, sampleRatio);
     }
-    return r;
-}
 
-//Extracts a sequence of bits from a number
-uint32_t extractBitSequence(uint32_t in, int start, int offset) {
-   return (in >> start) & ((1 << offset)-1);
-}
+    //Split one cache's sets over threads when asked and the policy allows it
+    if (threadsGiven && numThreads > 1){
+        if (exportFilename != NULL || liveInterval > 0){
+            fprintf(stderr, "-export and -live follow every access in order; simulating on one thread\n");
+        } else if (!defaultWrites){
+            fprintf(stderr, "The write policy options are modeled on one thread only; simulating on one thread\n");
+        } else if (conflictOptions){
+            fprintf(stderr, "The victim cache and way predictor are shared across sets; simulating on one thread\n");
+        } else if (resumable){
+            fprintf(stderr, "Checkpoints hold one cache's state; simulating on one thread\n");
+        } else if (prefetchKind != PREFETCH_NONE){
+            fprintf(stderr, "Prefetches cross sets; simulating on one thread\n");
+        } else if (modelShardable(replacementPolicy)){
+            return runSharded(filename, size, ways, line, replacementPolicy, numThreads, outputMode, extraStats);
+        } else {
+            fprintf(stderr, "The %s policy shares state across sets; simulating on one thread\n", modelPolicyName(replacementPolicy));
+        }
+    }
 
-//Sets a bit in a bit array
-void setBit(uint32_t A[],  uint32_t index){
-    A[index/32] |= 1 << (index%32);
-}
+    /////////////////////////////////////////////////////
+    // Single Cache Simulation
+    /////////////////////////////////////////////////////
 
-//Resets a bit in a bit array
-void resetBit(uint32_t A[],  uint32_t index){
-    A[index/32] &= ~(1 << (index%32));
+    runOptions options = {
+        .size = size,
+        .ways = ways,
+        .line = line,
+        .replacementPolicy = replacementPolicy,
+        .seed = seed,
+        .outputMode = outputMode,
+        .extraStats = extraStats,
+        .pipelineMode = pipelineMode,
+        .prefetcher = prefetchKind,
+        .prefetchDegree = prefetchDegree,
+        .writePolicy = writePolicy,
+        .writeAllocate = writeAllocate,
+        .writeBufferEntries = writeBufferEntries,
+        .victimEntries = victimEntries,
+        .wayPredictor = wayPredictor,
+        .coalesce = coalesce,
+        .exportFilename = exportFilename,
+        .exportInterval = exportInterval,
+        .reuseSample = reuseSample,
+        .fastForward = fastForward,
+        .checkpointFilename = checkpointFilename,
+        .checkpointAt = checkpointAt,
+        .restoreFilename = restoreFilename,
+        .liveInterval = liveInterval
+    };
+    return runSingle(filename, &options);
 }
 
-//Gets a bit in a bit array
-uint32_t getBit(uint32_t A[], uint32_t index){
-    return ((A[index/32] & (1 << (index%32) )) != 0);     
-}
 /////////////////////////////////////////////////////
 // End of file
 /////////////////////////////////////////////////////
\ No newline at end of file
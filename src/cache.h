@@ -6,7 +6,11 @@
 // File: cache.h
 /////////////////////////////////////////////////////
 
+#ifndef CACHE_H
+#define CACHE_H
+
 #include <stdint.h>
+#include <inttypes.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <ctype.h>
@@ -14,15 +18,64 @@
 #include <assert.h>
 #include <math.h>
 
-extern int write_xactions;
-extern int read_xactions;
+//Define constants
+//Hit/miss constants
+//The four final outcomes are also the 2-bit codes in binary result files
+#define HIT_SUCCESS 0
+#define CONFLICT_MISS 1
+#define COMPULSORY_MISS 2
+#define CAPACITY_MISS 3
+#define COHERENCE_MISS 4 //multi-core runs only; needs wide binary results
+#define UNKNOWN_MISS 5
+//Replacement policies
+#define FIFO 0
+#define LRU 1
+#define PLRU 2
+#define SRRIP 3
+#define BRRIP 4
+#define DRRIP 5
+#define RANDOM 6
+#define NUM_POLICIES 7
+
+//Address width is fixed at compile time so each build gets its own
+//specialized hot loop. Build cacheSim64 for 64-bit traces.
+#ifdef CACHESIM_ADDR64
+typedef uint64_t addr_t;
+#define ADDR_BITS 64
+#define ADDR_FORMAT "0x%08" PRIx64
+#else
+typedef uint32_t addr_t;
+#define ADDR_BITS 32
+#define ADDR_FORMAT "0x%08" PRIx32
+#endif
 
 void printHelp(const char * prog);
-uint32_t logBaseTwo(uint32_t num);
-uint32_t extractBitSequence(uint32_t in, int start, int offset);
-void setBit(uint32_t A[],  uint32_t index);
-void resetBit(uint32_t A[],  uint32_t index);
-uint32_t getBit(uint32_t A[],  uint32_t index);
+
+/////////////////////////////////////////////////////
+// Utility Functions
+// Inline so every module's hot loop can fold them in
+/////////////////////////////////////////////////////
+
+//Finds log base 2 of a number
+static inline uint32_t logBaseTwo(uint32_t num){
+    uint32_t r = 0;
+    while (num >>= 1){
+        r++;
+    }
+    return r;
+}
+
+//Extracts a sequence of bits from a number
+static inline addr_t extractBitSequence(addr_t in, int start, int offset) {
+   if (start >= ADDR_BITS){
+       return 0;
+   }
+   //A full-width mask can't be built by shifting
+   addr_t mask = offset >= ADDR_BITS ? ~(addr_t)0 : (((addr_t)1 << offset) - 1);
+   return (in >> start) & mask;
+}
+
+#endif
 
 /////////////////////////////////////////////////////
 // End of file
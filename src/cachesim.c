@@ -0,0 +1,110 @@
+/////////////////////////////////////////////////////
+// CSC 252 Project 4
+// Cache Simulator
+// Wilfred Wallis and Chris Dalke
+/////////////////////////////////////////////////////
+// File: cachesim.c
+/////////////////////////////////////////////////////
+
+#include "cache.h"
+#include "model.h"
+#include "cachesim.h"
+
+/////////////////////////////////////////////////////
+// Library functions
+// cacheSimCreate: builds a cache, or returns NULL if
+//                 the parameters don't make one
+// cacheSimSeed: seeds the randomized policies
+// cacheSimSetPrefetcher: attaches a PREFETCH_* prefetcher
+// cacheSimSetWritePolicy: write-back/through, allocation and write buffer
+// cacheSimSetVictimCache: puts a victim cache behind the cache
+// cacheSimSetWayPredictor: attaches a WAYPRED_* way predictor
+// cacheSimAccess: simulates one access
+// cacheSimAccessBatch: simulates an array of accesses
+// cacheSimGetStats: copies out the running totals
+// cacheSimModel: the underlying model, for model.h calls
+// cacheSimDestroy: frees the cache
+/////////////////////////////////////////////////////
+
+struct cacheSim {
+    cacheModel model;
+};
+
+cacheSim *cacheSimCreate(uint32_t size, uint32_t ways, uint32_t line, uint32_t replacementPolicy){
+    cacheSim *sim = malloc(sizeof(cacheSim));
+    if (sim == NULL){
+        return NULL;
+    }
+    if (modelInit(&sim->model, size, ways, line, replacementPolicy)){
+        free(sim);
+        return NULL;
+    }
+    return sim;
+}
+
+void cacheSimSeed(cacheSim *sim, uint64_t seed){
+    modelSeed(&sim->model, seed);
+}
+
+//Returns 0 on success
+int cacheSimSetPrefetcher(cacheSim *sim, uint32_t kind, uint32_t degree){
+    return modelSetPrefetcher(&sim->model, kind, degree);
+}
+
+int cacheSimSetWritePolicy(cacheSim *sim, uint32_t writePolicy, uint32_t writeAllocate, uint32_t bufferEntries){
+    return modelSetWritePolicy(&sim->model, writePolicy, writeAllocate, bufferEntries);
+}
+
+int cacheSimSetVictimCache(cacheSim *sim, uint32_t numEntries){
+    return modelSetVictimCache(&sim->model, numEntries);
+}
+
+int cacheSimSetWayPredictor(cacheSim *sim, uint32_t kind){
+    return modelSetWayPredictor(&sim->model, kind);
+}
+
+uint32_t cacheSimAccess(cacheSim *sim, addr_t address, uint32_t isStore){
+    return modelAccess(&sim->model, address, isStore);
+}
+
+//outcomes must have room for count codes
+void cacheSimAccessBatch(cacheSim *sim, const traceRecord *records, size_t count, uint8_t *outcomes){
+    //The model takes 32-bit counts
+    const size_t chunk = (size_t)1 << 30;
+    while (count > 0){
+        uint32_t part = count < chunk ? count : chunk;
+        modelAccessBatch(&sim->model, records, part, outcomes);
+        records += part;
+        outcomes += part;
+        count -= part;
+    }
+}
+
+void cacheSimGetStats(const cacheSim *sim, cacheSimStats *stats){
+    const cacheModel *model = &sim->model;
+    stats->accesses = model->numAccesses;
+    stats->hits = model->totalHits;
+    stats->misses = model->totalMisses;
+    stats->compulsoryMisses = model->compulsoryMisses;
+    stats->capacityMisses = model->capacityMisses;
+    stats->conflictMisses = model->conflictMisses;
+    stats->readXactions = model->readXactions;
+    stats->writeXactions = model->writeXactions + (model->writeBuf != NULL ? model->writeBuf->count : 0);
+    stats->readBytes = (model->readXactions + (model->prefetch != NULL ? model->prefetch->issued : 0)) * model->line;
+    stats->writeBytes = model->writeBytes + (model->writeBuf != NULL ? writeBufferPendingBytes(model->writeBuf) : 0);
+}
+
+cacheModel *cacheSimModel(cacheSim *sim){
+    return &sim->model;
+}
+
+void cacheSimDestroy(cacheSim *sim){
+    if (sim != NULL){
+        modelFree(&sim->model);
+        free(sim);
+    }
+}
+
+/////////////////////////////////////////////////////
+// End of file
+/////////////////////////////////////////////////////
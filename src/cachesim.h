@@ -0,0 +1,59 @@
+/////////////////////////////////////////////////////
+// CSC 252 Project 4
+// Cache Simulator
+// Wilfred Wallis and Chris Dalke
+/////////////////////////////////////////////////////
+// File: cachesim.h
+/////////////////////////////////////////////////////
+
+#ifndef CACHESIM_H
+#define CACHESIM_H
+
+//Library interface (libcachesim.a)
+//
+//A cacheSim is one cache built from (size, ways, line, policy).
+//Give it accesses one at a time or as an array of records and
+//each comes back as an outcome code: HIT_SUCCESS, CONFLICT_MISS,
+//COMPULSORY_MISS or CAPACITY_MISS. No trace or result files are
+//involved. Link with -lcachesim -lm -lpthread; build with
+//-DCACHESIM_ADDR64 to match a 64-bit library build.
+
+#include <stddef.h>
+#include <stdint.h>
+#include "cache.h"
+#include "trace.h"
+#include "model.h"
+
+typedef struct cacheSim cacheSim;
+
+//Running totals for a cacheSim
+typedef struct {
+    uint64_t accesses;
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t compulsoryMisses;
+    uint64_t capacityMisses;
+    uint64_t conflictMisses;
+    uint64_t readXactions;      //lines fetched on demand
+    uint64_t writeXactions;     //writes that reached memory, counting entries still in the write buffer
+    uint64_t readBytes;         //demand fills, store fills and prefetch fills
+    uint64_t writeBytes;        //writebacks and stores written through, after the write buffer (pending entries included)
+} cacheSimStats;
+
+cacheSim *cacheSimCreate(uint32_t size, uint32_t ways, uint32_t line, uint32_t replacementPolicy);
+void cacheSimSeed(cacheSim *sim, uint64_t seed);
+int cacheSimSetPrefetcher(cacheSim *sim, uint32_t kind, uint32_t degree);
+int cacheSimSetWritePolicy(cacheSim *sim, uint32_t writePolicy, uint32_t writeAllocate, uint32_t bufferEntries);
+int cacheSimSetVictimCache(cacheSim *sim, uint32_t numEntries);
+int cacheSimSetWayPredictor(cacheSim *sim, uint32_t kind);
+uint32_t cacheSimAccess(cacheSim *sim, addr_t address, uint32_t isStore);
+void cacheSimAccessBatch(cacheSim *sim, const traceRecord *records, size_t count, uint8_t *outcomes);
+void cacheSimGetStats(const cacheSim *sim, cacheSimStats *stats);
+cacheModel *cacheSimModel(cacheSim *sim);
+void cacheSimDestroy(cacheSim *sim);
+
+#endif
+
+/////////////////////////////////////////////////////
+// End of file
+/////////////////////////////////////////////////////
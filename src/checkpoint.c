@@ -0,0 +1,105 @@
+/////////////////////////////////////////////////////
+// CSC 252 Project 4
+// Cache Simulator
+// Wilfred Wallis and Chris Dalke
+/////////////////////////////////////////////////////
+// File: checkpoint.c
+/////////////////////////////////////////////////////
+
+#include "cache.h"
+#include "model.h"
+#include "checkpoint.h"
+
+/////////////////////////////////////////////////////
+// Checkpoints: the whole state of one cache model at
+// a point in the trace, so a later run can pick up
+// from there instead of simulating the prefix again
+/////////////////////////////////////////////////////
+
+//Fills in the header describing this model and the trace it runs on
+static void checkpointDescribe(checkpointHeader *header, const cacheModel *model, uint64_t position,
+                               uint64_t traceRecords, uint64_t traceChecksum){
+    memset(header, 0, sizeof(*header));
+    memcpy(header->magic, CHECKPOINT_MAGIC, sizeof(header->magic));
+    header->version = CHECKPOINT_VERSION;
+    header->addressWidth = ADDR_BITS;
+    header->size = model->size;
+    header->ways = model->ways;
+    header->line = model->line;
+    header->replacementPolicy = model->replacementPolicy;
+    header->prefetcher = model->prefetch != NULL ? model->prefetch->kind : PREFETCH_NONE;
+    header->prefetchDegree = model->prefetch != NULL ? model->prefetch->degree : 0;
+    header->writePolicy = model->writePolicy;
+    header->writeAllocate = model->writeAllocate;
+    header->writeBufferEntries = model->writeBuf != NULL ? model->writeBuf->capacity : 0;
+    header->victimEntries = model->victims != NULL ? model->victims->numEntries : 0;
+    header->wayPredictor = model->wayPredict != NULL ? model->wayPredict->kind : WAYPRED_NONE;
+    header->position = position;
+    header->traceRecords = traceRecords;
+    header->traceChecksum = traceChecksum;
+}
+
+//Writes the model's state after 'position' records of a trace identified by
+//traceIdentify (CHECKPOINT_TRACE_UNKNOWN records for live input); returns 0 on success
+int checkpointSave(char *filename, const cacheModel *model, uint64_t position, uint64_t traceRecords, uint64_t traceChecksum){
+    FILE *file = fopen(filename, "wb");
+    if (file == NULL){
+        return -1;
+    }
+    checkpointHeader header;
+    checkpointDescribe(&header, model, position, traceRecords, traceChecksum);
+    int failed = fwrite(&header, sizeof(header), 1, file) != 1 || modelWrite(model, file);
+    if (fclose(file) || failed){
+        remove(filename);
+        return -1;
+    }
+    return 0;
+}
+
+//Loads a checkpoint into a freshly initialized model, which must have the
+//configuration it was taken with, running on the same trace. Sets 'position'
+//to the trace records it covers. Returns 0 on success
+int checkpointRestore(char *filename, cacheModel *model, uint64_t *position, uint64_t traceRecords, uint64_t traceChecksum){
+    FILE *file = fopen(filename, "rb");
+    if (file == NULL){
+        return -1;
+    }
+    checkpointHeader header, expected;
+    if (fread(&header, sizeof(header), 1, file) != 1
+        || memcmp(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic)) || header.version != CHECKPOINT_VERSION){
+        printf("%s is not a checkpoint file\n", filename);
+        fclose(file);
+        return -1;
+    }
+
+    //Live input has no length to check, so only the configuration can be
+    if (header.traceRecords == CHECKPOINT_TRACE_UNKNOWN || traceRecords == CHECKPOINT_TRACE_UNKNOWN){
+        fprintf(stderr, "Note: cannot check that %s was taken on this trace\n", filename);
+        traceRecords = header.traceRecords;
+        traceChecksum = header.traceChecksum;
+    }
+
+    //Everything but the position has to agree, or the state would be misread
+    checkpointDescribe(&expected, model, header.position, traceRecords, traceChecksum);
+    if (header.traceRecords != expected.traceRecords || header.traceChecksum != expected.traceChecksum){
+        printf("%s was taken on a different trace (%llu records)\n", filename, (unsigned long long) header.traceRecords);
+        fclose(file);
+        return -1;
+    }
+    if (memcmp(&header, &expected, sizeof(header))){
+        printf("%s was taken with a different configuration (%uKB, %u ways, %uB lines, %s, prefetch %s, %u-bit addresses)\n",
+               filename, header.size, header.ways, header.line, modelPolicyName(header.replacementPolicy),
+               prefetchName(header.prefetcher), header.addressWidth);
+        fclose(file);
+        return -1;
+    }
+
+    int failed = modelRead(model, file);
+    fclose(file);
+    *position = header.position;
+    return failed ? -1 : 0;
+}
+
+/////////////////////////////////////////////////////
+// End of file
+/////////////////////////////////////////////////////
@@ -0,0 +1,50 @@
+/////////////////////////////////////////////////////
+// CSC 252 Project 4
+// Cache Simulator
+// Wilfred Wallis and Chris Dalke
+/////////////////////////////////////////////////////
+// File: checkpoint.h
+/////////////////////////////////////////////////////
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <stdint.h>
+#include "model.h"
+
+#define CHECKPOINT_MAGIC "CSIMCKP"
+#define CHECKPOINT_VERSION 4
+
+//traceRecords of a checkpoint taken on live input, which can't be checked
+#define CHECKPOINT_TRACE_UNKNOWN UINT64_MAX
+
+//Header at the start of a checkpoint file (little-endian),
+//followed by the model state from modelWrite
+typedef struct {
+    char magic[7];          //CHECKPOINT_MAGIC without its terminator
+    uint8_t version;
+    uint32_t addressWidth;  //ADDR_BITS of the build that wrote it
+    uint32_t size;          //cache configuration, which a restore must match
+    uint32_t ways;
+    uint32_t line;
+    uint32_t replacementPolicy;
+    uint32_t prefetcher;    //PREFETCH_*
+    uint32_t prefetchDegree;
+    uint32_t writePolicy;   //WRITE_BACK or WRITE_THROUGH
+    uint32_t writeAllocate;
+    uint32_t writeBufferEntries;
+    uint32_t victimEntries;
+    uint32_t wayPredictor;  //WAYPRED_*
+    uint64_t position;      //trace records consumed before the snapshot
+    uint64_t traceRecords;  //length of the trace it was taken on, or CHECKPOINT_TRACE_UNKNOWN
+    uint64_t traceChecksum; //payload checksum of a binary trace, 0 for text
+} checkpointHeader;
+
+int checkpointSave(char *filename, const cacheModel *model, uint64_t position, uint64_t traceRecords, uint64_t traceChecksum);
+int checkpointRestore(char *filename, cacheModel *model, uint64_t *position, uint64_t traceRecords, uint64_t traceChecksum);
+
+#endif
+
+/////////////////////////////////////////////////////
+// End of file
+/////////////////////////////////////////////////////
@@ -0,0 +1,334 @@
+/////////////////////////////////////////////////////
+// CSC 252 Project 4
+// Cache Simulator
+// Wilfred Wallis and Chris Dalke
+/////////////////////////////////////////////////////
+// File: coherence.c
+/////////////////////////////////////////////////////
+
+#include "cache.h"
+#include "trace.h"
+#include "model.h"
+#include "coherence.h"
+
+/////////////////////////////////////////////////////
+// Multi-core simulation with MESI coherence
+//
+// Every core has a private cache (a cacheModel) on a
+// snoopy bus. A block's MESI state is kept in its line
+// flags: Modified is LINE_DIRTY, Shared is LINE_SHARED,
+// Exclusive is neither, and Invalid is not cached.
+//
+// Read miss: BusRd. A Modified copy elsewhere is flushed
+//   to memory; all other copies become Shared. The block
+//   comes in Shared if anyone else has it, else Exclusive.
+// Write miss: BusRdX. Every other copy is invalidated
+//   (a Modified one is flushed first).
+// Write hit on Shared: BusUpgr, invalidating the others.
+// Write hit on Exclusive/Modified, read hit: no traffic.
+//
+// A miss on a block this core lost to an invalidation is
+// a coherence miss, the fourth class next to the 3Cs. It
+// is true sharing if the word now accessed was written by
+// the invalidating owner, and false sharing otherwise.
+// Written words are tracked from the invalidation on, one
+// bit per COHERENCE_WORD bytes, so this is an estimate.
+/////////////////////////////////////////////////////
+
+//Mixes a block number into a table index
+static inline uint64_t sharingHash(addr_t block){
+    return (uint64_t)block * 0x9E3779B97F4A7C15ULL;
+}
+
+static void sharingInit(sharingTable *table, uint64_t size){
+    table->entries = calloc(size, sizeof(sharingEntry));
+    table->mask = size - 1;
+    table->count = 0;
+}
+
+//Finds a block's entry, adding it if 'insert' is set; NULL if absent
+static sharingEntry *sharingFind(sharingTable *table, addr_t block, int insert){
+    uint64_t slot = (sharingHash(block) >> 20) & table->mask;
+    while (table->entries[slot].used){
+        if (table->entries[slot].block == block){
+            return &table->entries[slot];
+        }
+        slot = (slot + 1) & table->mask;
+    }
+    if (!insert){
+        return NULL;
+    }
+
+    //Keep the table at most half full
+    if ((table->count + 1) * 2 > table->mask + 1){
+        sharingTable grown;
+        sharingInit(&grown, (table->mask + 1) * 2);
+        for (uint64_t old = 0; old <= table->mask; old++){
+            if (table->entries[old].used){
+                *sharingFind(&grown, table->entries[old].block, 1) = table->entries[old];
+            }
+        }
+        grown.count = table->count;
+        free(table->entries);
+        *table = grown;
+        return sharingFind(table, block, 1);
+    }
+
+    sharingEntry *entry = &table->entries[slot];
+    memset(entry, 0, sizeof(*entry));
+    entry->used = 1;
+    entry->block = block;
+    table->count++;
+    return entry;
+}
+
+int coherenceInit(coherentSystem *sys, uint32_t numCores, uint32_t size, uint32_t ways, uint32_t line, uint32_t replacementPolicy, uint64_t seed){
+    memset(sys, 0, sizeof(*sys));
+    sys->cores = calloc(numCores, sizeof(cacheModel));
+    sys->coherenceMisses = calloc(numCores, sizeof(uint64_t));
+    for (uint32_t core = 0; core < numCores; core++){
+        if (modelInit(&sys->cores[core], size, ways, line, replacementPolicy)){
+            coherenceFree(sys);
+            return -1;
+        }
+        //Different seeds, so randomized policies don't evict in lockstep
+        modelSeed(&sys->cores[core], seed + core);
+        sys->numCores = core + 1;
+    }
+    sharingInit(&sys->sharing, 1024);
+    return 0;
+}
+
+//Removes every other core's copy of a block for a writer
+static void coherenceInvalidateOthers(coherentSystem *sys, uint32_t writer, addr_t address, addr_t block, uint32_t word){
+    sharingEntry *entry = NULL;
+    for (uint32_t core = 0; core < sys->numCores; core++){
+        if (core == writer){
+            continue;
+        }
+        int dirty = modelInvalidate(&sys->cores[core], address);
+        if (dirty < 0){
+            continue;
+        }
+        if (dirty){
+            //The modified copy goes to memory before the writer takes the block
+            sys->flushes++;
+            sys->cores[core].writeXactions++;
+        }
+        if (entry == NULL){
+            entry = sharingFind(&sys->sharing, block, 1);
+        }
+        entry->invalidated |= (uint64_t)1 << core;
+        entry->invalidations++;
+        sys->invalidations++;
+    }
+
+    //Start recording what the new owner writes
+    if (entry != NULL){
+        entry->writtenWords = (uint64_t)1 << word;
+        modelSetFlags(&sys->cores[writer], address, LINE_TRACKED, 0);
+    }
+}
+
+uint32_t coherenceAccess(coherentSystem *sys, uint32_t core, addr_t address, uint32_t isStore){
+    cacheModel *model = &sys->cores[core];
+    addr_t block = extractBitSequence(address, model->numOffsetBits, ADDR_BITS - model->numOffsetBits);
+    uint32_t word = ((address & (model->line - 1)) / COHERENCE_WORD) & 63;
+
+    //Snoop before the access changes anything
+    int flags = modelProbe(model, address);
+    uint32_t shared = 0;
+    if (flags < 0){
+        if (isStore){
+            sys->busReadExclusives++;
+        } else {
+            sys->busReads++;
+            for (uint32_t other = 0; other < sys->numCores; other++){
+                if (other == core){
+                    continue;
+                }
+                int otherFlags = modelProbe(&sys->cores[other], address);
+                if (otherFlags < 0){
+                    continue;
+                }
+                shared = 1;
+                if (otherFlags & LINE_DIRTY){
+                    sys->flushes++;
+                    sys->cores[other].writeXactions++;
+                }
+                modelSetFlags(&sys->cores[other], address, LINE_SHARED, LINE_DIRTY);
+            }
+        }
+    } else if (isStore && (flags & LINE_SHARED)){
+        sys->busUpgrades++;
+    }
+
+    uint32_t outcome = modelAccess(model, address, isStore);
+
+    //A miss on a block lost to another core's write is a coherence miss
+    if (outcome != HIT_SUCCESS){
+        sharingEntry *entry = sharingFind(&sys->sharing, block, 0);
+        if (entry != NULL && (entry->invalidated >> core) & 1){
+            entry->invalidated &= ~((uint64_t)1 << core);
+            entry->coherenceMisses++;
+            if ((entry->writtenWords >> word) & 1){
+                sys->trueSharingMisses++;
+            } else {
+                entry->falseSharingMisses++;
+                sys->falseSharingMisses++;
+            }
+
+            //The model counted it as one of the 3Cs
+            if (outcome == CAPACITY_MISS){
+                model->capacityMisses--;
+            } else if (outcome == CONFLICT_MISS){
+                model->conflictMisses--;
+            } else {
+                model->compulsoryMisses--;
+            }
+            sys->coherenceMisses[core]++;
+            outcome = COHERENCE_MISS;
+        }
+        if (shared){
+            modelSetFlags(model, address, LINE_SHARED, 0);
+        }
+    }
+
+    if (isStore){
+        if (flags < 0 || (flags & LINE_SHARED)){
+            //BusRdX / BusUpgr: this core becomes the only holder
+            coherenceInvalidateOthers(sys, core, address, block, word);
+            modelSetFlags(model, address, 0, LINE_SHARED);
+        } else if (flags & LINE_TRACKED){
+            sharingEntry *entry = sharingFind(&sys->sharing, block, 0);
+            if (entry != NULL){
+                entry->writtenWords |= (uint64_t)1 << word;
+            }
+        }
+    }
+
+    return outcome;
+}
+
+void coherencePrintStats(coherentSystem *sys, FILE *stream){
+    fprintf(stream, "Cores: %u; Protocol: MESI\n", sys->numCores);
+    modelPrintHeader(&sys->cores[0], stream);
+
+    for (uint32_t core = 0; core < sys->numCores; core++){
+        const cacheModel *model = &sys->cores[core];
+        fprintf(stream, "Core %u: Accesses: %" PRIu64 "; Hits: %" PRIu64 "; Misses: %" PRIu64 "\n", core,
+                model->numAccesses, model->totalHits, model->totalMisses);
+        if (model->numAccesses > 0){
+            modelPrintStats(model, stream);
+        }
+        fprintf(stream, "Compulsory: %" PRIu64 "; Capacity: %" PRIu64 "; Conflict: %" PRIu64 "; Coherence: %" PRIu64 "\n",
+                model->compulsoryMisses, model->capacityMisses, model->conflictMisses, sys->coherenceMisses[core]);
+    }
+
+    fprintf(stream, "Bus Reads: %" PRIu64 "; Bus Read-Exclusives: %" PRIu64 "; Bus Upgrades: %" PRIu64 "\n",
+            sys->busReads, sys->busReadExclusives, sys->busUpgrades);
+    fprintf(stream, "Invalidations: %" PRIu64 "; Flushes: %" PRIu64 "\n", sys->invalidations, sys->flushes);
+    fprintf(stream, "Coherence Misses: %" PRIu64 " (true sharing: %" PRIu64 "; false sharing: %" PRIu64 ")\n",
+            sys->trueSharingMisses + sys->falseSharingMisses, sys->trueSharingMisses, sys->falseSharingMisses);
+
+    //Pick out the blocks with the most false-sharing misses
+    sharingEntry *top[COHERENCE_HOTSPOTS];
+    uint32_t numTop = 0;
+    for (uint64_t slot = 0; slot <= sys->sharing.mask; slot++){
+        sharingEntry *entry = &sys->sharing.entries[slot];
+        if (!entry->used || entry->falseSharingMisses == 0){
+            continue;
+        }
+        uint32_t position = numTop < COHERENCE_HOTSPOTS ? numTop++ : COHERENCE_HOTSPOTS;
+        while (position > 0 && top[position - 1]->falseSharingMisses < entry->falseSharingMisses){
+            if (position < COHERENCE_HOTSPOTS){
+                top[position] = top[position - 1];
+            }
+            position--;
+        }
+        if (position < COHERENCE_HOTSPOTS){
+            top[position] = entry;
+        }
+    }
+    if (numTop > 0){
+        fprintf(stream, "Most falsely shared blocks:\n");
+    }
+    for (uint32_t t = 0; t < numTop; t++){
+        addr_t address = (addr_t)(top[t]->block << sys->cores[0].numOffsetBits);
+        fprintf(stream, "  " ADDR_FORMAT ": %" PRIu64 " false-sharing misses; %" PRIu64 " coherence misses; %" PRIu64 " invalidations\n",
+                address, top[t]->falseSharingMisses, top[t]->coherenceMisses, top[t]->invalidations);
+    }
+}
+
+void coherenceFree(coherentSystem *sys){
+    for (uint32_t core = 0; core < sys->numCores; core++){
+        modelFree(&sys->cores[core]);
+    }
+    free(sys->cores);
+    free(sys->coherenceMisses);
+    free(sys->sharing.entries);
+}
+
+/////////////////////////////////////////////////////
+// runCoherence: simulates a multi-core trace. Results
+// carry each access's core and may be coherence misses,
+// so binary results use four bits per access.
+/////////////////////////////////////////////////////
+
+int runCoherence(char *filename, uint32_t numCores, uint32_t size, uint32_t ways, uint32_t line, uint32_t replacementPolicy, uint64_t seed, uint32_t outputMode){
+    coherentSystem sys;
+    if (coherenceInit(&sys, numCores, size, ways, line, replacementPolicy, seed)){
+        printf("Could not set up a cache with these parameters\n");
+        return -1;
+    }
+    if (traceOpen(filename)){
+        printf("Could not open trace file\n");
+        coherenceFree(&sys);
+        return -1;
+    }
+
+    char *outputFilename = malloc(strlen(traceResultBase(filename)) + 16);
+    strcpy(outputFilename, traceResultBase(filename));
+    strcat(outputFilename, outputExtension(outputMode));
+    resultWriter writer;
+    if (outputOpen(&writer, outputFilename, outputMode | OUTPUT_WIDE | OUTPUT_CORES)){
+        printf("Could not open output file\n");
+        free(outputFilename);
+        traceClose();
+        coherenceFree(&sys);
+        return -1;
+    }
+    free(outputFilename);
+
+    traceRecord *batch = malloc(sizeof(traceRecord) * TRACE_BATCH_SIZE);
+    uint8_t *outcomes = malloc(sizeof(uint8_t) * TRACE_BATCH_SIZE);
+    uint32_t numRead;
+    int result = 0;
+    while (result == 0 && (numRead = traceReadBatch(batch, TRACE_BATCH_SIZE)) > 0){
+        for (uint32_t r = 0; r < numRead; r++){
+            if (batch[r].core >= numCores){
+                printf("Trace names core %u, but only %u cores were given\n", batch[r].core, numCores);
+                numRead = r;
+                result = -1;
+                break;
+            }
+            outcomes[r] = coherenceAccess(&sys, batch[r].core, batch[r].address, batch[r].isStore);
+        }
+        outputWriteBatch(&writer, batch, outcomes, numRead);
+    }
+    free(batch);
+    free(outcomes);
+
+    if (result == 0){
+        coherencePrintStats(&sys, stdout);
+    }
+
+    outputClose(&writer);
+    traceClose();
+    coherenceFree(&sys);
+    return result;
+}
+
+/////////////////////////////////////////////////////
+// End of file
+/////////////////////////////////////////////////////
@@ -0,0 +1,71 @@
+/////////////////////////////////////////////////////
+// CSC 252 Project 4
+// Cache Simulator
+// Wilfred Wallis and Chris Dalke
+/////////////////////////////////////////////////////
+// File: coherence.h
+/////////////////////////////////////////////////////
+
+#ifndef COHERENCE_H
+#define COHERENCE_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include "model.h"
+
+//Sharer sets are bitmasks, so this is the most cores a run can have
+#define COHERENCE_MAX_CORES 64
+
+//Granularity at which true and false sharing are told apart (B)
+#define COHERENCE_WORD 4
+
+//How many falsely shared blocks the report lists
+#define COHERENCE_HOTSPOTS 10
+
+//Sharing history of one block that has been invalidated at least once
+typedef struct {
+    addr_t block;            //block number (address without offset bits)
+    uint32_t used;
+    uint64_t invalidated;    //cores whose copy was invalidated and not yet fetched again
+    uint64_t writtenWords;   //words the owner has written since it last invalidated others
+    uint64_t invalidations;
+    uint64_t coherenceMisses;
+    uint64_t falseSharingMisses;
+} sharingEntry;
+
+//Open-addressing table of sharingEntry, keyed by block
+typedef struct {
+    sharingEntry *entries;
+    uint64_t mask;           //table size - 1
+    uint64_t count;
+} sharingTable;
+
+//Private caches of every core, kept coherent with snoopy MESI
+typedef struct {
+    uint32_t numCores;
+    cacheModel *cores;
+    uint64_t *coherenceMisses;   //per core
+
+    //Bus traffic
+    uint64_t busReads;           //BusRd: read misses
+    uint64_t busReadExclusives;  //BusRdX: write misses
+    uint64_t busUpgrades;        //BusUpgr: writes to a shared copy
+    uint64_t flushes;            //modified copies written back because another core wanted them
+    uint64_t invalidations;      //copies removed from other cores
+
+    uint64_t trueSharingMisses;
+    uint64_t falseSharingMisses;
+    sharingTable sharing;
+} coherentSystem;
+
+int coherenceInit(coherentSystem *sys, uint32_t numCores, uint32_t size, uint32_t ways, uint32_t line, uint32_t replacementPolicy, uint64_t seed);
+uint32_t coherenceAccess(coherentSystem *sys, uint32_t core, addr_t address, uint32_t isStore);
+void coherencePrintStats(coherentSystem *sys, FILE *stream);
+void coherenceFree(coherentSystem *sys);
+int runCoherence(char *filename, uint32_t numCores, uint32_t size, uint32_t ways, uint32_t line, uint32_t replacementPolicy, uint64_t seed, uint32_t outputMode);
+
+#endif
+
+/////////////////////////////////////////////////////
+// End of file
+/////////////////////////////////////////////////////
@@ -0,0 +1,271 @@
+/////////////////////////////////////////////////////
+// CSC 252 Project 4
+// Cache Simulator
+// Wilfred Wallis and Chris Dalke
+/////////////////////////////////////////////////////
+// File: generate.c
+/////////////////////////////////////////////////////
+
+#include "cache.h"
+#include "trace.h"
+#include "generate.h"
+
+/////////////////////////////////////////////////////
+// Synthetic trace generator
+//
+// Writes a binary trace of one access pattern straight
+// from a seeded generator, so the same spec and seed
+// always give the same trace. Every pattern takes O(1)
+// time and memory per access, which keeps traces with
+// billions of accesses practical:
+// stream: 8-byte words in order, wrapping at the footprint
+// stride: the same with a larger step
+// random: uniformly random 8-byte words
+// chase: a full-period LCG over the nodes stands in for
+//        a shuffled linked list, visiting each once a lap
+// zipf:  block ranks drawn by rejection-inversion
+//        (Hormann and Derflinger), scattered over the
+//        footprint by an odd multiplier
+/////////////////////////////////////////////////////
+
+static const char * const patternNames[NUM_PATTERNS] = {
+    "stream", "stride", "random", "chase", "zipf"
+};
+
+//Reads a byte count with an optional K, M or G suffix
+static int generateParseBytes(const char *text, uint64_t *bytes){
+    char *end;
+    if (!isdigit(text[0])){
+        return -1;
+    }
+    *bytes = strtoull(text, &end, 10);
+    switch (toupper(*end)){
+    case 'G': *bytes <<= 10; //fall through
+    case 'M': *bytes <<= 10; //fall through
+    case 'K': *bytes <<= 10; end++; break;
+    }
+    return *end == '\0' ? 0 : -1;
+}
+
+//Reads "pattern[:count=n][:footprint=bytes][:stride=bytes][:alpha=x][:stores=pct]"
+int generateParse(const char *text, generateSpec *spec){
+    char buffer[256];
+    snprintf(buffer, sizeof(buffer), "%s", text);
+
+    char *name = strtok(buffer, ":");
+    if (name == NULL){
+        return -1;
+    }
+    spec->pattern = NUM_PATTERNS;
+    for (uint32_t p = 0; p < NUM_PATTERNS; p++){
+        if (!strcmp(name, patternNames[p])){
+            spec->pattern = p;
+        }
+    }
+    if (spec->pattern == NUM_PATTERNS){
+        return -1;
+    }
+
+    //Defaults: 10M accesses over 64MB; pointer chasing only loads
+    spec->count = 10000000;
+    spec->footprint = 64 << 20;
+    spec->stride = spec->pattern == PATTERN_STRIDE ? 256 : spec->pattern == PATTERN_STREAM ? 8 : 64;
+    spec->alpha = 0.99;
+    spec->storePercent = spec->pattern == PATTERN_CHASE ? 0 : 30;
+
+    for (char *option = strtok(NULL, ":"); option != NULL; option = strtok(NULL, ":")){
+        if (!strncmp(option, "count=", 6) && isdigit(option[6])){
+            spec->count = strtoull(option + 6, NULL, 10);
+        } else if (!strncmp(option, "footprint=", 10)){
+            if (generateParseBytes(option + 10, &spec->footprint)){
+                return -1;
+            }
+        } else if (!strncmp(option, "stride=", 7)){
+            if (generateParseBytes(option + 7, &spec->stride)){
+                return -1;
+            }
+        } else if (!strncmp(option, "alpha=", 6)){
+            spec->alpha = strtod(option + 6, NULL);
+        } else if (!strncmp(option, "stores=", 7) && isdigit(option[7])){
+            spec->storePercent = strtoul(option + 7, NULL, 10);
+        } else {
+            return -1;
+        }
+    }
+
+    //Addresses must fit above the base
+    uint64_t space = ADDR_BITS >= 64 ? ~(uint64_t)0 - GENERATE_BASE : ((uint64_t)1 << ADDR_BITS) - GENERATE_BASE;
+    if (spec->stride == 0 || spec->footprint < 8 || spec->footprint < spec->stride || spec->footprint > space
+        || spec->alpha <= 0 || spec->storePercent > 100){
+        return -1;
+    }
+    return 0;
+}
+
+//splitmix64: one well-mixed value per call
+static inline uint64_t generateNext(uint64_t *state){
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+//Uniform double in [0, 1)
+static inline double generateUniform(uint64_t *state){
+    return (generateNext(state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+//Largest power of two no greater than n, at least 1
+static uint64_t generateFloorPow2(uint64_t n){
+    uint64_t p = 1;
+    while (p <= n / 2){
+        p <<= 1;
+    }
+    return p;
+}
+
+/////////////////////////////////////////////////////
+// Zipf sampling by rejection-inversion
+/////////////////////////////////////////////////////
+
+typedef struct {
+    double exponent;
+    double numElements;
+    double hIntegralX1;
+    double hIntegralN;
+    double s;
+} zipfSampler;
+
+//log1p(x) / x and expm1(x) / x, stable near zero
+static double zipfHelper1(double x){
+    return fabs(x) > 1e-8 ? log1p(x) / x : 1 - x * (0.5 - x * (1.0 / 3 - 0.25 * x));
+}
+
+static double zipfHelper2(double x){
+    return fabs(x) > 1e-8 ? expm1(x) / x : 1 + x * 0.5 * (1 + x / 3 * (1 + 0.25 * x));
+}
+
+static double zipfH(const zipfSampler *zipf, double x){
+    return exp(-zipf->exponent * log(x));
+}
+
+static double zipfHIntegral(const zipfSampler *zipf, double x){
+    double logX = log(x);
+    return zipfHelper2((1 - zipf->exponent) * logX) * logX;
+}
+
+static double zipfHIntegralInverse(const zipfSampler *zipf, double x){
+    double t = x * (1 - zipf->exponent);
+    if (t < -1){
+        t = -1;
+    }
+    return exp(zipfHelper1(t) * x);
+}
+
+static void zipfInit(zipfSampler *zipf, uint64_t numElements, double exponent){
+    zipf->exponent = exponent;
+    zipf->numElements = numElements;
+    zipf->hIntegralX1 = zipfHIntegral(zipf, 1.5) - 1;
+    zipf->hIntegralN = zipfHIntegral(zipf, numElements + 0.5);
+    zipf->s = 2 - zipfHIntegralInverse(zipf, zipfHIntegral(zipf, 2.5) - zipfH(zipf, 2));
+}
+
+//Rank in [1, numElements]; rank k is drawn with weight k^-exponent
+static uint64_t zipfSample(const zipfSampler *zipf, uint64_t *state){
+    for (;;){
+        double u = zipf->hIntegralN + generateUniform(state) * (zipf->hIntegralX1 - zipf->hIntegralN);
+        double x = zipfHIntegralInverse(zipf, u);
+        double k = floor(x + 0.5);
+        if (k < 1){
+            k = 1;
+        } else if (k > zipf->numElements){
+            k = zipf->numElements;
+        }
+        if (k - x <= zipf->s || u >= zipfHIntegral(zipf, k + 0.5) - zipfH(zipf, k)){
+            return (uint64_t) k;
+        }
+    }
+}
+
+/////////////////////////////////////////////////////
+// runGenerate: writes the trace a spec describes
+/////////////////////////////////////////////////////
+
+int runGenerate(const char *text, char *outputFilename, uint64_t seed){
+    generateSpec spec;
+    if (generateParse(text, &spec)){
+        printf("Unrecognized trace pattern\n");
+        return -1;
+    }
+
+    traceWriter writer;
+    if (traceWriterOpen(&writer, outputFilename, 0)){
+        printf("Could not open output file\n");
+        return -1;
+    }
+
+    uint64_t state = seed;
+    uint64_t words = spec.footprint / 8;
+    uint64_t position = 0;  //stream / stride: offset into the footprint
+
+    //Chase and zipf work on whole units of 'stride' bytes, a power of two of them
+    uint64_t numUnits = generateFloorPow2(spec.footprint / spec.stride);
+    uint64_t node = generateNext(&state) & (numUnits - 1);
+    uint64_t increment = generateNext(&state) | 1;  //odd, so the LCG has full period
+    zipfSampler zipf;
+    if (spec.pattern == PATTERN_ZIPF){
+        zipfInit(&zipf, numUnits, spec.alpha);
+    }
+
+    traceRecord *batch = malloc(sizeof(traceRecord) * TRACE_BATCH_SIZE);
+    for (uint64_t done = 0; done < spec.count; ){
+        uint32_t count = spec.count - done < TRACE_BATCH_SIZE ? spec.count - done : TRACE_BATCH_SIZE;
+        for (uint32_t r = 0; r < count; r++){
+            uint64_t offset;
+            switch (spec.pattern){
+            case PATTERN_STREAM:
+            case PATTERN_STRIDE:
+                offset = position;
+                position += spec.stride;
+                if (position >= spec.footprint){
+                    position -= spec.footprint;
+                }
+                break;
+            case PATTERN_RANDOM:
+                offset = (generateNext(&state) % words) * 8;
+                break;
+            case PATTERN_CHASE:
+                //a = 1 mod 4 and an odd increment give period numUnits
+                node = (node * 0x5851F42D4C957F2Dull + increment) & (numUnits - 1);
+                offset = node * spec.stride;
+                break;
+            default:
+                //Scatter ranks over the blocks; odd multipliers permute a power of two
+                offset = (((zipfSample(&zipf, &state) - 1) * 0x9E3779B97F4A7C15ull) & (numUnits - 1)) * spec.stride
+                       + (generateNext(&state) % (spec.stride / 8 ? spec.stride / 8 : 1)) * 8;
+                break;
+            }
+            batch[r].address = (addr_t)(GENERATE_BASE + offset);
+            batch[r].isStore = spec.storePercent && generateNext(&state) % 100 < spec.storePercent;
+            batch[r].core = 0;
+        }
+        traceWriterWrite(&writer, batch, count);
+        done += count;
+    }
+    free(batch);
+
+    //Keep standard output clean when the trace itself went there
+    FILE *report = strcmp(outputFilename, TRACE_STDIN) ? stdout : stderr;
+    long outputSize = traceWriterClose(&writer);
+    if (outputSize > 0){
+        fprintf(report, "Generated %llu %s records: %ld bytes\n", (unsigned long long) spec.count,
+            patternNames[spec.pattern], outputSize);
+    } else {
+        fprintf(report, "Generated %llu %s records\n", (unsigned long long) spec.count, patternNames[spec.pattern]);
+    }
+    return 0;
+}
+
+/////////////////////////////////////////////////////
+// End of file
+/////////////////////////////////////////////////////
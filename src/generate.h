@@ -0,0 +1,42 @@
+/////////////////////////////////////////////////////
+// CSC 252 Project 4
+// Cache Simulator
+// Wilfred Wallis and Chris Dalke
+/////////////////////////////////////////////////////
+// File: generate.h
+/////////////////////////////////////////////////////
+
+#ifndef GENERATE_H
+#define GENERATE_H
+
+#include <stdint.h>
+
+//Synthetic access patterns
+#define PATTERN_STREAM 0  //consecutive words
+#define PATTERN_STRIDE 1  //a fixed stride
+#define PATTERN_RANDOM 2  //uniform over the footprint
+#define PATTERN_CHASE 3   //dependent walk visiting every node once per lap
+#define PATTERN_ZIPF 4    //blocks reused with Zipfian popularity
+#define NUM_PATTERNS 5
+
+//Where generated addresses start
+#define GENERATE_BASE 0x10000000
+
+//What to generate, parsed from "pattern[:option=value...]"
+typedef struct {
+    uint32_t pattern;
+    uint64_t count;         //accesses to generate
+    uint64_t footprint;     //bytes the addresses range over
+    uint64_t stride;        //bytes between accesses (stride), nodes (chase) or blocks (zipf)
+    double alpha;           //Zipf exponent
+    uint32_t storePercent;  //share of accesses that are stores
+} generateSpec;
+
+int generateParse(const char *text, generateSpec *spec);
+int runGenerate(const char *text, char *outputFilename, uint64_t seed);
+
+#endif
+
+/////////////////////////////////////////////////////
+// End of file
+/////////////////////////////////////////////////////
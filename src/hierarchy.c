@@ -0,0 +1,226 @@
+/////////////////////////////////////////////////////
+// CSC 252 Project 4
+// Cache Simulator
+// Wilfred Wallis and Chris Dalke
+/////////////////////////////////////////////////////
+// File: hierarchy.c
+/////////////////////////////////////////////////////
+
+#include "cache.h"
+#include "trace.h"
+#include "hierarchy.h"
+
+/////////////////////////////////////////////////////
+// Multi-level cache hierarchy
+//
+// Each level is an ordinary cacheModel. A demand miss at
+// one level becomes a fetch from the next, and blocks
+// leaving a level are passed down:
+//
+// NINE: misses allocate in every level on the way up;
+//   only dirty victims are written back into the level below.
+// Inclusive: as NINE, and a block evicted from this level is
+//   back-invalidated from every level above. Dirty upper
+//   copies are written back with it.
+// Exclusive: the level holds only victims of the level above.
+//   A hit moves the block up and out of this level; every
+//   victim from above, clean or dirty, is installed here.
+//
+// Read/write transactions of a level are its fetches from
+// and writebacks to the level below (memory for the last).
+/////////////////////////////////////////////////////
+
+static void hierarchyEvict(cacheHierarchy *h, uint32_t level, addr_t address, uint32_t dirty);
+static uint32_t hierarchyDemand(cacheHierarchy *h, uint32_t level, addr_t address, uint32_t isStore);
+
+int hierarchyInit(cacheHierarchy *h, const cacheConfig *configs, uint32_t numLevels){
+    h->numLevels = numLevels;
+    h->levels = calloc(numLevels, sizeof(cacheModel));
+    h->inclusion = calloc(numLevels, sizeof(uint32_t));
+    h->backInvalidations = calloc(numLevels, sizeof(uint64_t));
+
+    for (uint32_t level = 0; level < numLevels; level++){
+        //Lower levels may use larger lines, never smaller ones; exclusive levels swap whole lines
+        if (level > 0 && (configs[level].line < configs[level - 1].line
+            || (configs[level].inclusion == INCLUSION_EXCLUSIVE && configs[level].line != configs[level - 1].line))){
+            h->numLevels = level;
+            hierarchyFree(h);
+            return -1;
+        }
+        if (modelInit(&h->levels[level], configs[level].size, configs[level].ways, configs[level].line, configs[level].replacementPolicy)){
+            h->numLevels = level;
+            hierarchyFree(h);
+            return -1;
+        }
+        modelSeed(&h->levels[level], configs[level].seed);
+        h->inclusion[level] = configs[level].inclusion;
+    }
+    return 0;
+}
+
+//Supplies a block that 'level - 1' missed on
+static void hierarchyFetch(cacheHierarchy *h, uint32_t level, addr_t address){
+    //Past the last level the block comes from memory, already counted as a read
+    if (level == h->numLevels){
+        return;
+    }
+
+    if (h->inclusion[level] == INCLUSION_EXCLUSIVE){
+        uint32_t dirty;
+        if (modelExtract(&h->levels[level], address, &dirty) == HIT_SUCCESS){
+            //The block moves up; if it was dirty, it stays dirty above
+            if (dirty){
+                modelMarkDirty(&h->levels[level - 1], address);
+            }
+        } else {
+            hierarchyFetch(h, level + 1, address);
+        }
+    } else {
+        hierarchyDemand(h, level, address, 0);
+    }
+}
+
+//Demand access at one level, fetching and evicting as needed
+static uint32_t hierarchyDemand(cacheHierarchy *h, uint32_t level, addr_t address, uint32_t isStore){
+    cacheModel *model = &h->levels[level];
+    uint32_t outcome = modelAccess(model, address, isStore);
+
+    if (outcome != HIT_SUCCESS){
+        //Fetch before passing the victim down, so an exclusive level
+        //can't evict the block we are about to take from it
+        uint32_t evicted = model->evicted;
+        uint32_t evictedDirty = model->evictedDirty;
+        addr_t evictedAddress = model->evictedAddress;
+
+        hierarchyFetch(h, level + 1, address);
+        if (evicted){
+            hierarchyEvict(h, level, evictedAddress, evictedDirty);
+        }
+    }
+    return outcome;
+}
+
+//Handles a block leaving 'level'
+static void hierarchyEvict(cacheHierarchy *h, uint32_t level, addr_t address, uint32_t dirty){
+    //An inclusive level can't drop a block the levels above still hold
+    if (level > 0 && h->inclusion[level] == INCLUSION_INCLUSIVE){
+        uint32_t line = h->levels[level].line;
+        for (uint32_t above = 0; above < level; above++){
+            uint32_t aboveLine = h->levels[above].line;
+            for (uint32_t offset = 0; offset < line; offset += aboveLine){
+                int state = modelInvalidate(&h->levels[above], address + offset);
+                if (state < 0){
+                    continue;
+                }
+                h->backInvalidations[level]++;
+
+                //Dirty data above now has to be written back from here
+                if (state == 1 && !dirty){
+                    dirty = 1;
+                    h->levels[level].writeXactions++;
+                }
+            }
+        }
+    }
+
+    //The last level writes back to memory, which modelFill already counted
+    uint32_t below = level + 1;
+    if (below == h->numLevels){
+        return;
+    }
+
+    if (h->inclusion[below] == INCLUSION_EXCLUSIVE || dirty){
+        cacheModel *model = &h->levels[below];
+        modelInstall(model, address, dirty);
+        if (model->evicted){
+            hierarchyEvict(h, below, model->evictedAddress, model->evictedDirty);
+        }
+    }
+}
+
+//Simulates one access from the processor, returning its L1 outcome
+uint32_t hierarchyAccess(cacheHierarchy *h, addr_t address, uint32_t isStore){
+    return hierarchyDemand(h, 0, address, isStore);
+}
+
+void hierarchyPrintStats(const cacheHierarchy *h, FILE *stream){
+    static const char * const inclusionNames[] = { "nine", "inclusive", "exclusive" };
+
+    for (uint32_t level = 0; level < h->numLevels; level++){
+        const cacheModel *model = &h->levels[level];
+        fprintf(stream, "Level %u: %uKB; ", level + 1, model->size);
+        modelPrintHeader(model, stream);
+        fprintf(stream, "Policy: %s%s%s\n", modelPolicyName(model->replacementPolicy),
+                level > 0 ? "; " : "", level > 0 ? inclusionNames[h->inclusion[level]] : "");
+        fprintf(stream, "Accesses: %" PRIu64 "; Hits: %" PRIu64 "; Misses: %" PRIu64 "\n",
+                model->totalHits + model->totalMisses, model->totalHits, model->totalMisses);
+        modelPrintStats(model, stream);
+        fprintf(stream, "Compulsory: %" PRIu64 "; Capacity: %" PRIu64 "; Conflict: %" PRIu64 "\n",
+                model->compulsoryMisses, model->capacityMisses, model->conflictMisses);
+        fprintf(stream, "Installs: %" PRIu64 "; Back-Invalidations: %" PRIu64 "\n",
+                model->installs, h->backInvalidations[level]);
+    }
+}
+
+void hierarchyFree(cacheHierarchy *h){
+    for (uint32_t level = 0; level < h->numLevels; level++){
+        modelFree(&h->levels[level]);
+    }
+    free(h->levels);
+    free(h->inclusion);
+    free(h->backInvalidations);
+}
+
+/////////////////////////////////////////////////////
+// runHierarchy: simulates the trace through the levels,
+// writing L1 outcomes per access and stats per level
+/////////////////////////////////////////////////////
+
+int runHierarchy(char *filename, const cacheConfig *configs, uint32_t numLevels, uint32_t outputMode){
+    cacheHierarchy h;
+    if (hierarchyInit(&h, configs, numLevels)){
+        printf("Could not set up the hierarchy (line sizes may not shrink from one level to the next, and exclusive levels must match the level above)\n");
+        return -1;
+    }
+    if (traceOpen(filename)){
+        printf("Could not open trace file\n");
+        hierarchyFree(&h);
+        return -1;
+    }
+
+    char *outputFilename = malloc(strlen(traceResultBase(filename)) + 16);
+    strcpy(outputFilename, traceResultBase(filename));
+    strcat(outputFilename, outputExtension(outputMode));
+    resultWriter writer;
+    if (outputOpen(&writer, outputFilename, outputMode)){
+        printf("Could not open output file\n");
+        free(outputFilename);
+        traceClose();
+        hierarchyFree(&h);
+        return -1;
+    }
+    free(outputFilename);
+
+    traceRecord *batch = malloc(sizeof(traceRecord) * TRACE_BATCH_SIZE);
+    uint8_t *outcomes = malloc(sizeof(uint8_t) * TRACE_BATCH_SIZE);
+    uint32_t numRead;
+    while ((numRead = traceReadBatch(batch, TRACE_BATCH_SIZE)) > 0){
+        for (uint32_t r = 0; r < numRead; r++){
+            outcomes[r] = hierarchyAccess(&h, batch[r].address, batch[r].isStore);
+        }
+        outputWriteBatch(&writer, batch, outcomes, numRead);
+    }
+    free(batch);
+    free(outcomes);
+
+    hierarchyPrintStats(&h, stdout);
+
+    outputClose(&writer);
+    traceClose();
+    hierarchyFree(&h);
+    return 0;
+}
+
+/////////////////////////////////////////////////////
+// End of file
+/////////////////////////////////////////////////////
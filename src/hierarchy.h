@@ -0,0 +1,34 @@
+/////////////////////////////////////////////////////
+// CSC 252 Project 4
+// Cache Simulator
+// Wilfred Wallis and Chris Dalke
+/////////////////////////////////////////////////////
+// File: hierarchy.h
+/////////////////////////////////////////////////////
+
+#ifndef HIERARCHY_H
+#define HIERARCHY_H
+
+#include <stdint.h>
+#include "model.h"
+#include "multi.h"
+
+//A stack of cache levels; levels[0] is L1, the last level talks to memory
+typedef struct {
+    uint32_t numLevels;
+    cacheModel *levels;
+    uint32_t *inclusion;           //inclusion policy of each level (unused for L1)
+    uint64_t *backInvalidations;   //blocks each level removed from the levels above
+} cacheHierarchy;
+
+int hierarchyInit(cacheHierarchy *h, const cacheConfig *configs, uint32_t numLevels);
+uint32_t hierarchyAccess(cacheHierarchy *h, addr_t address, uint32_t isStore);
+void hierarchyPrintStats(const cacheHierarchy *h, FILE *stream);
+void hierarchyFree(cacheHierarchy *h);
+int runHierarchy(char *filename, const cacheConfig *configs, uint32_t numLevels, uint32_t outputMode);
+
+#endif
+
+/////////////////////////////////////////////////////
+// End of file
+/////////////////////////////////////////////////////
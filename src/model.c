@@ -0,0 +1,1321 @@
+/////////////////////////////////////////////////////
+// CSC 252 Project 4
+// Cache Simulator
+// Wilfred Wallis and Chris Dalke
+/////////////////////////////////////////////////////
+// File: model.c
+/////////////////////////////////////////////////////
+
+#include "cache.h"
+#include "model.h"
+
+/////////////////////////////////////////////////////
+// Model functions
+// modelInit: sets up an empty cache for a configuration
+// modelSeed: reseeds the RANDOM / BRRIP generator
+// modelAccess: simulates one access, returns its outcome
+// modelAccessBatch: simulates a batch of accesses
+// modelShardInit / modelAccessShard / modelShardFree: simulate
+//   one interleaved share of the sets on its own thread
+// modelInstall / modelExtract / modelInvalidate / modelMarkDirty:
+//   operations a cache hierarchy needs between levels
+// modelProbe / modelSetFlags: snoop and change a block's state
+// modelPrintHeader / modelPrintStats: GOLD-format output
+// modelPrintExtraStats: additional statistics
+// modelScaleShadow: shrinks the 3C shadow cache for set sampling
+// modelFree: releases the model's memory
+// modelPolicyName / modelPolicyParse: policy names
+/////////////////////////////////////////////////////
+
+//Re-reference prediction values for the RRIP policies
+#define RRPV_MAX 3
+//BRRIP fills at RRPV_MAX - 1 once in this many fills
+#define BRRIP_LONG_ODDS 32
+//DRRIP: one SRRIP and one BRRIP leader set in every constituency of this many sets
+#define DUEL_CONSTITUENCY 32
+//DRRIP: 10-bit saturating policy selector
+#define PSEL_MAX 1023
+//Seed used until modelSeed is called
+#define DEFAULT_SEED 1
+
+static const char * const policyNames[NUM_POLICIES] = { "fifo", "lru", "plru", "srrip", "brrip", "drrip", "random" };
+
+int modelInit(cacheModel *model, uint32_t size, uint32_t ways, uint32_t line, uint32_t replacementPolicy){
+    model->size = size;
+    model->ways = ways;
+    model->line = line;
+    model->replacementPolicy = replacementPolicy;
+    model->writePolicy = WRITE_BACK;
+    model->writeAllocate = 1;
+    model->treeBits = NULL;
+    model->setCounts = NULL;
+    model->prefetch = NULL;
+    model->writeBuf = NULL;
+    model->victims = NULL;
+    model->wayPredict = NULL;
+    model->tagCompares = 0;
+    model->lastLine = NULL;
+    if (replacementPolicy >= NUM_POLICIES){
+        return -1;
+    }
+
+    //Calculate the cache attributes
+    uint64_t capacity = (uint64_t)size * 1024;
+    model->numSets = capacity / ((uint64_t)line * ways);
+    model->numIndexBits = logBaseTwo(model->numSets);
+    model->numOffsetBits = logBaseTwo(line);
+    model->numTagBits = (ADDR_BITS) - (model->numIndexBits + model->numOffsetBits);
+
+    //Index and offset are bit fields, so both counts must be powers of two
+    if (model->numSets == 0 || (model->numSets & (model->numSets - 1)) || (line & (line - 1))){
+        return -1;
+    }
+
+    //Keys need one spare bit above the tag for the valid flag
+    if (model->numTagBits >= 64){
+        return -1;
+    }
+
+    //Setup the tag store on the heap, aligned to host cache lines and zeroed (all ways empty)
+    size_t numLines = (size_t)model->numSets * ways;
+    void *lines = NULL;
+    if (numLines == 0 || posix_memalign(&lines, HOST_CACHE_LINE, numLines * sizeof(cacheLine))){
+        return -1;
+    }
+    memset(lines, 0, numLines * sizeof(cacheLine));
+    model->lines = lines;
+    tagStoreSelect(&model->search, ways);
+
+    //Tree-PLRU needs a power-of-two number of ways, and one bit per tree node
+    if (replacementPolicy == PLRU){
+        if ((ways & (ways - 1)) != 0 || ways > 64){
+            free(model->lines);
+            return -1;
+        }
+        model->treeBits = calloc(model->numSets, sizeof(uint64_t));
+    }
+
+    //Initialize the first-touch tracker; pages are allocated as blocks are touched
+    if (blockSetInit(&model->touchedBlocks)){
+        free(model->lines);
+        free(model->treeBits);
+        return -1;
+    }
+
+    //Initialize fully associative cache simulation
+    //We use this to detect conflict vs capacity misses
+    //It is LRU for every policy but FIFO, the usual reference for the 3C split
+    uint32_t fullyAssocNumWays = capacity / (line); //figure out the number of ways we need such that numSets = 1;
+    uint32_t fullyAssocNumSets = capacity / ((uint64_t)line * fullyAssocNumWays); //This should be equal to one
+    assert(fullyAssocNumSets == 1);
+    if (shadowInit(&model->fullyAssocCache, fullyAssocNumWays, replacementPolicy == FIFO ? FIFO : LRU)){
+        free(model->lines);
+        free(model->treeBits);
+        blockSetFree(&model->touchedBlocks);
+        return -1;
+    }
+
+    model->ageClock = 0;
+    model->setFirst = 0;
+    model->setStride = 1;
+    model->psel = PSEL_MAX / 2;
+    modelSeed(model, DEFAULT_SEED);
+    model->numAccesses = 0;
+    model->totalHits = 0;
+    model->totalMisses = 0;
+    model->readXactions = 0;
+    model->writeXactions = 0;
+    model->storeFills = 0;
+    model->writebacks = 0;
+    model->storeWrites = 0;
+    model->writeBytes = 0;
+    model->compulsoryMisses = 0;
+    model->capacityMisses = 0;
+    model->conflictMisses = 0;
+    model->installs = 0;
+    model->invalidations = 0;
+    model->evicted = 0;
+    return 0;
+}
+
+void modelSeed(cacheModel *model, uint64_t seed){
+    //xorshift must never hold zero
+    model->randomState = seed ? seed : DEFAULT_SEED;
+}
+
+//Starts keeping per-set hit, miss, eviction and writeback counts; returns 0 on success
+int modelTrackSets(cacheModel *model){
+    if (model->setCounts == NULL){
+        model->setCounts = calloc(model->numSets, sizeof(setCounters));
+    }
+    return model->setCounts == NULL ? -1 : 0;
+}
+
+//Attaches a prefetcher; degree 0 picks its default. Returns 0 on success
+int modelSetPrefetcher(cacheModel *model, uint32_t kind, uint32_t degree){
+    prefetchFree(model->prefetch);
+    model->prefetch = NULL;
+    if (kind == PREFETCH_NONE){
+        return 0;
+    }
+    model->prefetch = prefetchCreate(kind, degree, (uint64_t)model->numSets * model->ways);
+    return model->prefetch == NULL ? -1 : 0;
+}
+
+//Chooses what stores do: WRITE_BACK or WRITE_THROUGH on a hit, whether a
+//miss allocates, and how many entries the write buffer has (0 for none).
+//Returns 0 on success
+int modelSetWritePolicy(cacheModel *model, uint32_t writePolicy, uint32_t writeAllocate, uint32_t bufferEntries){
+    if (writePolicy != WRITE_BACK && writePolicy != WRITE_THROUGH){
+        return -1;
+    }
+    model->writePolicy = writePolicy;
+    model->writeAllocate = writeAllocate != 0;
+    writeBufferFree(model->writeBuf);
+    model->writeBuf = NULL;
+    if (bufferEntries > 0){
+        model->writeBuf = writeBufferCreate(bufferEntries, model->line);
+        if (model->writeBuf == NULL){
+            return -1;
+        }
+    }
+    return 0;
+}
+
+//Whether stores are handled as cacheSim always has: write-back, write-allocate, no buffer
+int modelDefaultWrites(const cacheModel *model){
+    return model->writePolicy == WRITE_BACK && model->writeAllocate && model->writeBuf == NULL;
+}
+
+//Puts a victim cache of numEntries blocks behind the cache (0 for none).
+//Returns 0 on success
+int modelSetVictimCache(cacheModel *model, uint32_t numEntries){
+    victimFree(model->victims);
+    model->victims = NULL;
+    if (numEntries == 0){
+        return 0;
+    }
+    model->victims = victimCreate(numEntries);
+    return model->victims == NULL ? -1 : 0;
+}
+
+//Attaches a WAYPRED_* way predictor; returns 0 on success
+int modelSetWayPredictor(cacheModel *model, uint32_t kind){
+    waypredFree(model->wayPredict);
+    model->wayPredict = NULL;
+    if (kind == WAYPRED_NONE){
+        return 0;
+    }
+    model->wayPredict = waypredCreate(kind, model->numSets, model->ways);
+    return model->wayPredict == NULL ? -1 : 0;
+}
+
+//Renumbers every set's ages 1..ways, keeping their order
+//Called once every 2^32 accesses, when the age clock would wrap
+static void modelRebaseAges(cacheModel *model){
+    uint32_t ways = model->ways;
+
+    //Only FIFO and LRU keep stamps; the RRIP policies keep RRPVs in the same field
+    if (model->replacementPolicy != FIFO && model->replacementPolicy != LRU){
+        model->ageClock = 0;
+        return;
+    }
+
+    for (uint32_t currentSet = model->setFirst; currentSet < model->numSets; currentSet += model->setStride){
+        cacheLine *set = model->lines + (size_t)currentSet * ways;
+        uint32_t rank = 0;
+        uint32_t previousAge = 0;
+
+        //Selection by age: repeatedly take the oldest age above the last one
+        for (;;){
+            uint32_t nextAge = UINT32_MAX;
+            for (uint32_t currentWay = 0; currentWay < ways; currentWay++){
+                if (set[currentWay].age > previousAge && set[currentWay].age < nextAge){
+                    nextAge = set[currentWay].age;
+                }
+            }
+            if (nextAge == UINT32_MAX){
+                break;
+            }
+            rank++;
+            for (uint32_t currentWay = 0; currentWay < ways; currentWay++){
+                if (set[currentWay].age == nextAge){
+                    set[currentWay].age = rank;
+                }
+            }
+            previousAge = nextAge;
+        }
+    }
+    model->ageClock = ways;
+}
+
+//Advances the age clock, renumbering ages first if it is about to wrap
+static inline uint32_t modelTick(cacheModel *model){
+    if (model->ageClock == UINT32_MAX - 1){
+        modelRebaseAges(model);
+    }
+    return ++model->ageClock;
+}
+
+//Rebuilds the address of the block a way holds
+static inline addr_t modelLineAddress(const cacheModel *model, uint32_t indexBits, uint64_t key){
+    uint32_t tagShift = model->numIndexBits + model->numOffsetBits;
+    addr_t tagPart = tagShift >= ADDR_BITS ? 0 : (addr_t)(key >> 1) << tagShift;
+    return tagPart | ((addr_t)indexBits << model->numOffsetBits);
+}
+
+//Finds the way holding a key, or returns ways if it is not in the set
+//Empty ways have key 0, so one compare checks both tag and valid bit
+static inline uint32_t modelFindWay(const cacheModel *model, const cacheLine *set, uint64_t key){
+    //One way is a single compare; anything wider goes to the kernel chosen for this CPU
+    if (model->ways == 1){
+        return set[0].key == key ? 0 : 1;
+    }
+    return model->search.find(set, model->ways, key);
+}
+
+/////////////////////////////////////////////////////
+// Replacement policies
+//
+// Each policy is three inline steps: policyHit on a hit,
+// policyVictim to choose the way a miss replaces, and
+// policyFill once the new block is in. The policy is a
+// parameter; the access kernels pass a constant, so each
+// kernel is compiled for one policy with no branch on it.
+//
+// FIFO: evict the lowest fill stamp
+// LRU: evict the lowest use stamp
+// PLRU: a binary tree of bits per set points at the victim
+// SRRIP: 2-bit re-reference prediction values (RRPV) in
+//   the age field; fill at RRPV_MAX - 1, hit sets 0,
+//   evict the first way at RRPV_MAX
+// BRRIP: SRRIP that fills at RRPV_MAX, except 1 in 32
+// DRRIP: leader sets duel SRRIP against BRRIP, and the
+//   selector picks the policy for all other sets
+// RANDOM: seeded xorshift picks the victim
+//
+// Empty ways are always filled first.
+/////////////////////////////////////////////////////
+
+//xorshift64*: fast, reproducible for a given seed
+static inline uint64_t modelRandom(cacheModel *model){
+    uint64_t x = model->randomState;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    model->randomState = x;
+    return x * 0x2545F4914F6CDD1DULL;
+}
+
+//FIFO / LRU: choose item with lowest age
+//Empty ways have age 0, so they are always used first
+static inline uint32_t modelOldestWay(const cacheModel *model, const cacheLine *set){
+    if (model->ways == 1){
+        return 0;
+    }
+    return model->search.oldest(set, model->ways);
+}
+
+//PLRU: point every node on the way's path away from it
+static inline void plruTouch(uint64_t *bits, uint32_t ways, uint32_t way){
+    uint32_t node = 1;
+    for (uint32_t span = ways >> 1; span; span >>= 1){
+        uint32_t right = (way & span) != 0;
+        if (right){
+            *bits &= ~((uint64_t)1 << node);
+        } else {
+            *bits |= (uint64_t)1 << node;
+        }
+        node = node * 2 + right;
+    }
+}
+
+//PLRU: follow the bits down to the victim
+static inline uint32_t plruVictim(uint64_t bits, uint32_t ways){
+    uint32_t node = 1;
+    uint32_t way = 0;
+    for (uint32_t span = ways >> 1; span; span >>= 1){
+        uint32_t right = (bits >> node) & 1;
+        way |= right ? span : 0;
+        node = node * 2 + right;
+    }
+    return way;
+}
+
+//RRIP: evict the first way predicted distant, aging the set until one is
+static inline uint32_t rripVictim(cacheLine *set, uint32_t ways){
+    uint32_t selectedWay = 0;
+    uint32_t highest = 0;
+    for (uint32_t currentWay = 0; currentWay < ways; currentWay++){
+        if (set[currentWay].age >= RRPV_MAX){
+            return currentWay;
+        }
+        if (set[currentWay].age > highest){
+            highest = set[currentWay].age;
+            selectedWay = currentWay;
+        }
+    }
+
+    //Aging every way by the same amount leaves the first highest one at RRPV_MAX
+    uint32_t shift = RRPV_MAX - highest;
+    for (uint32_t currentWay = 0; currentWay < ways; currentWay++){
+        set[currentWay].age += shift;
+    }
+    return selectedWay;
+}
+
+//BRRIP fill: mostly distant, occasionally long
+static inline uint32_t brripFillAge(cacheModel *model){
+    return (modelRandom(model) % BRRIP_LONG_ODDS) == 0 ? RRPV_MAX - 1 : RRPV_MAX;
+}
+
+static inline __attribute__((always_inline)) void policyHit(cacheModel *model, cacheLine *set, uint32_t way, uint32_t indexBits, uint32_t numReadLines, const uint32_t policy){
+    switch (policy){
+        case LRU:
+            set[way].age = numReadLines; //Use line number as age
+            break;
+        case PLRU:
+            plruTouch(&model->treeBits[indexBits], model->ways, way);
+            break;
+        case SRRIP:
+        case BRRIP:
+        case DRRIP:
+            set[way].age = 0;
+            break;
+        default:
+            break;
+    }
+}
+
+static inline __attribute__((always_inline)) uint32_t policyVictim(cacheModel *model, cacheLine *set, uint32_t indexBits, const uint32_t policy){
+    uint32_t ways = model->ways;
+    if (policy == FIFO || policy == LRU){
+        return modelOldestWay(model, set);
+    }
+
+    uint32_t emptyWay = modelFindWay(model, set, 0);
+    if (emptyWay < ways){
+        return emptyWay;
+    }
+    switch (policy){
+        case PLRU:
+            return plruVictim(model->treeBits[indexBits], ways);
+        case RANDOM:
+            return modelRandom(model) % ways;
+        default:
+            return rripVictim(set, ways);
+    }
+}
+
+static inline __attribute__((always_inline)) void policyFill(cacheModel *model, cacheLine *set, uint32_t way, uint32_t indexBits, const uint32_t policy){
+    switch (policy){
+        case PLRU:
+            plruTouch(&model->treeBits[indexBits], model->ways, way);
+            break;
+        case SRRIP:
+            set[way].age = RRPV_MAX - 1;
+            break;
+        case BRRIP:
+            set[way].age = brripFillAge(model);
+            break;
+        case DRRIP: {
+            //A miss in a leader set counts against its policy
+            uint32_t member = indexBits % DUEL_CONSTITUENCY;
+            uint32_t useBrrip;
+            if (member == 0){
+                model->psel += model->psel < PSEL_MAX;
+                useBrrip = 0;
+            } else if (member == DUEL_CONSTITUENCY - 1){
+                model->psel -= model->psel > 0;
+                useBrrip = 1;
+            } else {
+                useBrrip = model->psel > PSEL_MAX / 2;
+            }
+            set[way].age = useBrrip ? brripFillAge(model) : RRPV_MAX - 1;
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+//Sends a write to memory, through the write buffer if there is one
+static inline void modelWriteMemory(cacheModel *model, addr_t address, uint32_t bytes){
+    if (model->writeBuf != NULL){
+        bytes = writeBufferPut(model->writeBuf, address, bytes);
+        if (bytes == 0){
+            return;
+        }
+    }
+    model->writeXactions++;
+    model->writeBytes += bytes;
+}
+
+//Replaces a way with a new block, writing back the old one if it was dirty
+static inline void modelFill(cacheModel *model, cacheLine *line, uint32_t indexBits, uint64_t key, uint32_t numReadLines){
+    //Remember what was evicted so a hierarchy can pass it down
+    model->evicted = line->key != 0;
+    if (model->evicted){
+        model->evictedAddress = modelLineAddress(model, indexBits, line->key);
+        model->evictedDirty = line->flags & LINE_DIRTY;
+        if (line->flags & LINE_PREFETCHED){
+            model->prefetch->unused++;
+        }
+        if (model->setCounts != NULL){
+            model->setCounts[indexBits].evictions++;
+            model->setCounts[indexBits].writebacks += model->evictedDirty != 0;
+        }
+    }
+
+    //With a victim cache the old item goes there, and only what that pushes out may need writing
+    if (model->victims != NULL && model->evicted){
+        addr_t outBlock;
+        uint32_t outDirty;
+        if (victimInsert(model->victims, model->evictedAddress >> model->numOffsetBits, line->flags & LINE_DIRTY, &outBlock, &outDirty) && outDirty){
+            model->writebacks++;
+            modelWriteMemory(model, outBlock << model->numOffsetBits, model->line);
+        }
+    }
+
+    //When we evict an old item, if the dirty bit has been set, write it to memory
+    else if (line->flags & LINE_DIRTY){
+        model->writebacks++;
+        modelWriteMemory(model, model->evictedAddress, model->line);
+    }
+
+    //update new cache items, stamping the line number as the age for our replacement policy
+    line->key = key;
+    line->age = numReadLines;
+    line->flags = 0;
+}
+
+//Identify which type of miss occurred
+//COMPULSORY_MISS: The data address has never been accessed before
+//CONFLICT_MISS: A fully associative cache of the same size would have hit
+//CAPACITY_MISS: A fully associative cache of the same size would have missed too
+static inline uint32_t modelClassifyMiss(cacheModel *model, addr_t currentDataBlock, uint32_t fullyAssocHitStatus){
+    //Recording the block here covers every first touch, since a hit implies an earlier miss or install
+    if (blockSetInsert(&model->touchedBlocks,currentDataBlock)){
+        model->compulsoryMisses++;
+        return COMPULSORY_MISS;
+    } else if (fullyAssocHitStatus == HIT_SUCCESS){
+        model->conflictMisses++;
+        return CONFLICT_MISS;
+    } else {
+        model->capacityMisses++;
+        return CAPACITY_MISS;
+    }
+}
+
+//Like modelClassifyMiss for a shard, which has no shadow cache:
+//misses that are not compulsory come back as UNKNOWN_MISS
+static inline uint32_t modelFirstTouch(cacheModel *model, addr_t currentDataBlock){
+    if (blockSetInsert(&model->touchedBlocks,currentDataBlock)){
+        model->compulsoryMisses++;
+        return COMPULSORY_MISS;
+    }
+    return UNKNOWN_MISS;
+}
+
+//The access itself, specialized by the kernels below for a constant policy
+//A deferred access skips the shadow cache and leaves conflict vs capacity open
+//Demand miss bookkeeping for the prefetcher; returns 1 if a stream buffer supplied the block
+static uint32_t modelPrefetchMiss(cacheModel *model, addr_t block){
+    prefetcher *pf = model->prefetch;
+    if (pf->kind == PREFETCH_STREAM){
+        if (prefetchStreamTake(pf, block)){
+            return 1;
+        }
+        prefetchStreamAllocate(pf, block);
+    }
+    prefetchCheckPollution(pf, block);
+    return 0;
+}
+
+//Fills a block into the cache ahead of demand, unless it is already there.
+//Not a demand access: the shadow cache, miss counts and the evicted block
+//a hierarchy looks at are left alone.
+static inline __attribute__((always_inline)) void modelPrefetchFill(cacheModel *model, addr_t block, const uint32_t policy){
+    prefetcher *pf = model->prefetch;
+    uint32_t ways = model->ways;
+    addr_t address = block << model->numOffsetBits;
+    addr_t tagBits = extractBitSequence(address,ADDR_BITS-model->numTagBits,model->numTagBits);
+    uint32_t indexBits = extractBitSequence(address,model->numOffsetBits,model->numIndexBits);
+    cacheLine *set = model->lines + (size_t)indexBits * ways;
+    uint64_t key = LINE_KEY(tagBits);
+
+    if (modelFindWay(model, set, key) < ways){
+        pf->redundant++;
+        return;
+    }
+
+    uint32_t evicted = model->evicted;
+    uint32_t evictedDirty = model->evictedDirty;
+    addr_t evictedAddress = model->evictedAddress;
+
+    uint32_t numReadLines = modelTick(model);
+    uint32_t selectedWay = policyVictim(model, set, indexBits, policy);
+    uint32_t victimWasDemand = set[selectedWay].key != 0 && !(set[selectedWay].flags & LINE_PREFETCHED);
+    modelFill(model, &set[selectedWay], indexBits, key, numReadLines);
+    policyFill(model, set, selectedWay, indexBits, policy);
+    set[selectedWay].flags = LINE_PREFETCHED;
+    pf->issued++;
+
+    //A demand block pushed out by a prefetch may come back as a pollution miss
+    if (victimWasDemand){
+        prefetchNoteVictim(pf, model->evictedAddress >> model->numOffsetBits);
+    }
+
+    model->evicted = evicted;
+    model->evictedDirty = evictedDirty;
+    model->evictedAddress = evictedAddress;
+}
+
+//Trains the prefetcher on a demand access and fills what it asks for
+static inline __attribute__((always_inline)) void modelPrefetch(cacheModel *model, addr_t address, uint32_t trigger, const uint32_t policy){
+    addr_t blocks[PREFETCH_MAX_DEGREE];
+    uint32_t count = prefetchCandidates(model->prefetch, address, model->numOffsetBits, trigger, blocks);
+    for (uint32_t c = 0; c < count; c++){
+        modelPrefetchFill(model, blocks[c], policy);
+    }
+}
+
+//What a store does to a line it hits, or to memory
+static inline void modelStore(cacheModel *model, cacheLine *line, addr_t address){
+    if (line != NULL && model->writePolicy == WRITE_BACK){
+        //Set the dirty bit to true for the data we have written to
+        line->flags |= LINE_DIRTY;
+    } else {
+        //Written through, or around the cache on a no-write-allocate miss
+        model->storeWrites++;
+        modelWriteMemory(model, address, STORE_BYTES);
+    }
+}
+
+//Counts the tag comparisons of a lookup that found selectedWay (ways on a miss).
+//A correct prediction compares one tag; otherwise every way is compared.
+//Returns the predictor's table slot for this access.
+static inline uint64_t modelPredictWay(cacheModel *model, uint32_t indexBits, addr_t block, uint32_t selectedWay){
+    wayPredictor *wp = model->wayPredict;
+    uint64_t slot = waypredSlot(wp, indexBits, block);
+    if (selectedWay < model->ways){
+        wp->predictions++;
+        if (wp->table[slot] == selectedWay){
+            wp->correct++;
+            model->tagCompares++;
+            return slot;
+        }
+    }
+    model->tagCompares += model->ways;
+    return slot;
+}
+
+//Hits to the block the previous access left in model->lastLine.
+//That line is the most recent in its set and the block the most recent
+//in the shadow cache, so LRU and FIFO order, the PLRU tree and the
+//shadow are already as a full access would leave them; RRIP only needs
+//the line's RRPV reset. 'stores' of the 'count' records are stores.
+static inline __attribute__((always_inline)) void modelRepeatHits(cacheModel *model, const traceRecord *records, uint32_t count, uint32_t stores, const uint32_t policy){
+    model->numAccesses += count;
+    model->totalHits += count;
+    model->evicted = 0;
+    if (model->setCounts != NULL){
+        model->setCounts[model->lastSet].hits += count;
+    }
+    if (policy == SRRIP || policy == BRRIP || policy == DRRIP){
+        model->lastLine->age = 0;
+    }
+    if (stores > 0){
+        if (model->writePolicy == WRITE_BACK){
+            model->lastLine->flags |= LINE_DIRTY;
+        } else {
+            for (uint32_t r = 0; r < count; r++){
+                if (records[r].isStore){
+                    modelStore(model, NULL, records[r].address);
+                }
+            }
+        }
+    }
+}
+
+static inline __attribute__((always_inline)) uint32_t modelAccessWith(cacheModel *model, addr_t address, uint32_t isStore, const uint32_t policy, const uint32_t deferred){
+    uint32_t ways = model->ways;
+
+    //Get the address (index + tag bits) and cut off the offset bits
+    //Since offset bits are within a data block, we just need to see if the block has loaded
+    addr_t currentDataBlock = extractBitSequence(address,model->numOffsetBits,ADDR_BITS-model->numOffsetBits);
+
+    //Back-to-back accesses to one block skip the search and the shadow cache
+    if (currentDataBlock == model->lastBlock && model->lastLine != NULL){
+        traceRecord record = { address, isStore, 0 };
+        modelRepeatHits(model, &record, 1, isStore, policy);
+        return HIT_SUCCESS;
+    }
+
+    model->numAccesses++;
+    model->evicted = 0;
+    uint32_t numReadLines = modelTick(model);
+
+    //Get the index and tag bits
+    addr_t tagBits = extractBitSequence(address,ADDR_BITS-model->numTagBits,model->numTagBits);
+    uint32_t indexBits = extractBitSequence(address,model->numOffsetBits,model->numIndexBits);
+
+    //The ways of this set, side by side
+    cacheLine *set = model->lines + (size_t)indexBits * ways;
+    uint64_t key = LINE_KEY(tagBits);
+
+    /////////////////////////////////////////////////////
+    // Cache Search
+    /////////////////////////////////////////////////////
+
+    uint32_t selectedWay = modelFindWay(model, set, key);
+    uint32_t hitStatus;
+    uint32_t prefetchTrigger = 1;
+
+    //Tag comparisons are only worth counting when something changes them
+    uint64_t predictSlot = 0;
+    if (model->wayPredict != NULL){
+        predictSlot = modelPredictWay(model, indexBits, currentDataBlock, selectedWay);
+    } else if (model->victims != NULL){
+        model->tagCompares += ways;
+    }
+
+    /////////////////////////////////////////////////////
+    // Fully Associative Cache Simulation
+    /////////////////////////////////////////////////////
+
+    uint32_t fullyAssocHitStatus = deferred ? UNKNOWN_MISS : shadowAccess(&model->fullyAssocCache, currentDataBlock);
+
+    /////////////////////////////////////////////////////
+    // Hit Handling
+    /////////////////////////////////////////////////////
+
+    if (selectedWay < ways){
+        //Record the hit
+        model->totalHits++;
+        hitStatus = HIT_SUCCESS;
+        if (model->setCounts != NULL){
+            model->setCounts[indexBits].hits++;
+        }
+
+        //Let the replacement policy record that we have accessed this cache
+        policyHit(model, set, selectedWay, indexBits, numReadLines, policy);
+
+        //The first use of a prefetched line is what made the prefetch useful
+        prefetchTrigger = 0;
+        if (model->prefetch != NULL && (set[selectedWay].flags & LINE_PREFETCHED)){
+            set[selectedWay].flags &= ~LINE_PREFETCHED;
+            model->prefetch->useful++;
+            prefetchTrigger = 1;
+        }
+    }
+
+    /////////////////////////////////////////////////////
+    // Miss Handling
+    /////////////////////////////////////////////////////
+
+    else {
+        //A stream buffer may hold the block, sparing the trip to memory
+        uint32_t buffered = model->prefetch != NULL && modelPrefetchMiss(model, currentDataBlock);
+
+        //So may the victim cache, which swaps it back in
+        uint32_t victimDirty = 0;
+        uint32_t rescued = 0;
+        if (!buffered && model->victims != NULL){
+            model->tagCompares += model->victims->numEntries;
+            rescued = victimTake(model->victims, currentDataBlock, &victimDirty);
+            if (rescued){
+                if (fullyAssocHitStatus == HIT_SUCCESS){
+                    model->victims->conflictRemoved++;
+                } else {
+                    model->victims->capacityRemoved++;
+                }
+            }
+        }
+
+        if (buffered || rescued){
+            //Record the hit
+            model->totalHits++;
+            hitStatus = HIT_SUCCESS;
+            if (model->setCounts != NULL){
+                model->setCounts[indexBits].hits++;
+            }
+            blockSetInsert(&model->touchedBlocks, currentDataBlock);
+        } else {
+            //Record the miss
+            model->totalMisses++;
+            if (model->setCounts != NULL){
+                model->setCounts[indexBits].misses++;
+            }
+            hitStatus = deferred ? modelFirstTouch(model, currentDataBlock)
+                                 : modelClassifyMiss(model, currentDataBlock, fullyAssocHitStatus);
+        }
+
+        if (buffered || rescued || !isStore || model->writeAllocate){
+            //Increment 'read from memory' counter
+            if (!buffered && !rescued){
+                model->readXactions++;
+                model->storeFills += isStore;
+            }
+            selectedWay = policyVictim(model, set, indexBits, policy);
+            modelFill(model, &set[selectedWay], indexBits, key, numReadLines);
+            policyFill(model, set, selectedWay, indexBits, policy);
+            if (victimDirty){
+                set[selectedWay].flags |= LINE_DIRTY;
+            }
+        } else {
+            //No-write-allocate: the store goes to memory and the set is left alone
+            selectedWay = ways;
+        }
+    }
+
+    /////////////////////////////////////////////////////
+    // Store Instruction Dirty Bit Handling
+    /////////////////////////////////////////////////////
+
+    if (isStore){
+        modelStore(model, selectedWay < ways ? &set[selectedWay] : NULL, address);
+    }
+
+    /////////////////////////////////////////////////////
+    // Prefetching
+    /////////////////////////////////////////////////////
+
+    //The predictor learns where the block ended up
+    if (model->wayPredict != NULL && selectedWay < ways){
+        model->wayPredict->table[predictSlot] = selectedWay;
+    }
+
+    //Prefetches train on every access and may move blocks, so they rule out the repeat
+    //fast path; so do the victim cache and way predictor, which count every lookup
+    model->lastLine = NULL;
+    if (model->prefetch != NULL){
+        modelPrefetch(model, address, prefetchTrigger, policy);
+    } else if (selectedWay < ways && model->victims == NULL && model->wayPredict == NULL){
+        model->lastLine = &set[selectedWay];
+        model->lastBlock = currentDataBlock;
+        model->lastSet = indexBits;
+    }
+
+    return hitStatus;
+}
+
+//One access kernel, one batch kernel and one shard kernel per policy
+//The shard kernel only simulates records in the sets the shard owns
+#define MODEL_KERNELS(policy, name) \
+    static uint32_t modelAccess##name(cacheModel *model, addr_t address, uint32_t isStore){ \
+        return modelAccessWith(model, address, isStore, policy, 0); \
+    } \
+    static void modelAccessBatch##name(cacheModel *model, const traceRecord *records, uint32_t count, uint8_t *outcomes){ \
+        for (uint32_t r = 0; r < count; r++){ \
+            outcomes[r] = modelAccessWith(model, records[r].address, records[r].isStore, policy, 0); \
+        } \
+    } \
+    static void modelAccessRuns##name(cacheModel *model, const traceRecord *records, const traceRun *runs, uint32_t numRuns, uint8_t *outcomes){ \
+        for (uint32_t n = 0; n < numRuns; n++){ \
+            const traceRecord *run = records + runs[n].first; \
+            uint8_t *runOutcomes = outcomes + runs[n].first; \
+            runOutcomes[0] = modelAccessWith(model, run[0].address, run[0].isStore, policy, 0); \
+            if (runs[n].length > 1 && model->lastLine != NULL){ \
+                modelRepeatHits(model, run + 1, runs[n].length - 1, runs[n].stores, policy); \
+                memset(runOutcomes + 1, HIT_SUCCESS, runs[n].length - 1); \
+            } else { \
+                for (uint32_t r = 1; r < runs[n].length; r++){ \
+                    runOutcomes[r] = modelAccessWith(model, run[r].address, run[r].isStore, policy, 0); \
+                } \
+            } \
+        } \
+    } \
+    static void modelAccessShard##name(cacheModel *model, const traceRecord *records, uint64_t count, uint8_t *outcomes){ \
+        uint32_t first = model->setFirst, stride = model->setStride; \
+        for (uint64_t r = 0; r < count; r++){ \
+            uint32_t indexBits = extractBitSequence(records[r].address,model->numOffsetBits,model->numIndexBits); \
+            if (indexBits % stride == first){ \
+                outcomes[r] = modelAccessWith(model, records[r].address, records[r].isStore, policy, 1); \
+            } \
+        } \
+    }
+
+MODEL_KERNELS(FIFO, Fifo)
+MODEL_KERNELS(LRU, Lru)
+MODEL_KERNELS(PLRU, Plru)
+MODEL_KERNELS(SRRIP, Srrip)
+MODEL_KERNELS(BRRIP, Brrip)
+MODEL_KERNELS(DRRIP, Drrip)
+MODEL_KERNELS(RANDOM, Random)
+
+typedef uint32_t (*modelAccessKernel)(cacheModel *, addr_t, uint32_t);
+typedef void (*modelBatchKernel)(cacheModel *, const traceRecord *, uint32_t, uint8_t *);
+typedef void (*modelRunsKernel)(cacheModel *, const traceRecord *, const traceRun *, uint32_t, uint8_t *);
+typedef void (*modelShardKernel)(cacheModel *, const traceRecord *, uint64_t, uint8_t *);
+
+//Indexed by policy
+static const modelAccessKernel accessKernels[NUM_POLICIES] = {
+    modelAccessFifo, modelAccessLru, modelAccessPlru, modelAccessSrrip,
+    modelAccessBrrip, modelAccessDrrip, modelAccessRandom
+};
+static const modelBatchKernel batchKernels[NUM_POLICIES] = {
+    modelAccessBatchFifo, modelAccessBatchLru, modelAccessBatchPlru, modelAccessBatchSrrip,
+    modelAccessBatchBrrip, modelAccessBatchDrrip, modelAccessBatchRandom
+};
+static const modelRunsKernel runsKernels[NUM_POLICIES] = {
+    modelAccessRunsFifo, modelAccessRunsLru, modelAccessRunsPlru, modelAccessRunsSrrip,
+    modelAccessRunsBrrip, modelAccessRunsDrrip, modelAccessRunsRandom
+};
+static const modelShardKernel shardKernels[NUM_POLICIES] = {
+    modelAccessShardFifo, modelAccessShardLru, modelAccessShardPlru, modelAccessShardSrrip,
+    modelAccessShardBrrip, modelAccessShardDrrip, modelAccessShardRandom
+};
+
+uint32_t modelAccess(cacheModel *model, addr_t address, uint32_t isStore){
+    return accessKernels[model->replacementPolicy](model, address, isStore);
+}
+
+//Simulates count records, writing each outcome; the policy is chosen once per batch
+void modelAccessBatch(cacheModel *model, const traceRecord *records, uint32_t count, uint8_t *outcomes){
+    batchKernels[model->replacementPolicy](model, records, count, outcomes);
+}
+
+//Simulates the records covered by runs from traceCoalesce, writing an outcome per record.
+//Each run's first access is simulated in full and the rest are applied as a group of
+//hits, which leaves exactly the state one-at-a-time simulation would.
+void modelAccessRuns(cacheModel *model, const traceRecord *records, const traceRun *runs, uint32_t numRuns, uint8_t *outcomes){
+    runsKernels[model->replacementPolicy](model, records, runs, numRuns, outcomes);
+}
+
+/////////////////////////////////////////////////////
+// Set sharding
+//
+// Sets never share blocks, so disjoint groups of sets
+// can be simulated on separate threads. A shard is a
+// copy of the owner model that shares its tag store but
+// has its own counters, age clock and first-touch set,
+// and owns every set with index % numShards == shard.
+// Ages only matter within a set, so a per-shard clock
+// gives the same replacement decisions.
+//
+// Shards don't use the shadow cache, which sees every
+// access in trace order; their non-compulsory misses
+// come back as UNKNOWN_MISS for the caller to resolve.
+// Policies with state shared across sets (the random
+// number stream, DRRIP's selector) can't be sharded.
+/////////////////////////////////////////////////////
+
+int modelShardable(uint32_t policy){
+    return policy == FIFO || policy == LRU || policy == PLRU || policy == SRRIP;
+}
+
+int modelShardInit(cacheModel *shard, const cacheModel *owner, uint32_t shardIndex, uint32_t numShards){
+    *shard = *owner;
+    shard->setFirst = shardIndex;
+    shard->setStride = numShards;
+    shard->ageClock = 0;
+    shard->numAccesses = 0;
+    shard->totalHits = 0;
+    shard->totalMisses = 0;
+    shard->readXactions = 0;
+    shard->writeXactions = 0;
+    shard->storeFills = 0;
+    shard->writebacks = 0;
+    shard->storeWrites = 0;
+    shard->writeBytes = 0;
+    shard->compulsoryMisses = 0;
+    shard->capacityMisses = 0;
+    shard->conflictMisses = 0;
+    shard->installs = 0;
+    shard->invalidations = 0;
+    shard->evicted = 0;
+    shard->setCounts = NULL;
+    shard->prefetch = NULL;
+    shard->writeBuf = NULL;
+    shard->victims = NULL;
+    shard->wayPredict = NULL;
+    shard->lastLine = NULL;
+    return blockSetInit(&shard->touchedBlocks);
+}
+
+//Simulates the shard's share of count records; other records' outcomes are left alone
+void modelAccessShard(cacheModel *shard, const traceRecord *records, uint64_t count, uint8_t *outcomes){
+    shardKernels[shard->replacementPolicy](shard, records, count, outcomes);
+}
+
+//Frees what the shard owns; the tag store belongs to the owner
+void modelShardFree(cacheModel *shard){
+    blockSetFree(&shard->touchedBlocks);
+}
+
+//Puts a block into the cache without fetching it, as when a level
+//above writes it back or hands over its victim. It is not a demand
+//access, so it only counts as an install.
+void modelInstall(cacheModel *model, addr_t address, uint32_t dirty){
+    uint32_t ways = model->ways;
+    model->evicted = 0;
+    model->lastLine = NULL;
+    model->installs++;
+    uint32_t numReadLines = modelTick(model);
+
+    addr_t tagBits = extractBitSequence(address,ADDR_BITS-model->numTagBits,model->numTagBits);
+    uint32_t indexBits = extractBitSequence(address,model->numOffsetBits,model->numIndexBits);
+    addr_t currentDataBlock = extractBitSequence(address,model->numOffsetBits,ADDR_BITS-model->numOffsetBits);
+    cacheLine *set = model->lines + (size_t)indexBits * ways;
+    uint64_t key = LINE_KEY(tagBits);
+
+    shadowAccess(&model->fullyAssocCache, currentDataBlock);
+    blockSetInsert(&model->touchedBlocks, currentDataBlock);
+
+    uint32_t selectedWay = modelFindWay(model, set, key);
+    uint32_t policy = model->replacementPolicy;
+    if (selectedWay < ways){
+        policyHit(model, set, selectedWay, indexBits, numReadLines, policy);
+    } else {
+        selectedWay = policyVictim(model, set, indexBits, policy);
+        modelFill(model, &set[selectedWay], indexBits, key, numReadLines);
+        policyFill(model, set, selectedWay, indexBits, policy);
+    }
+
+    if (dirty){
+        set[selectedWay].flags |= LINE_DIRTY;
+    }
+}
+
+//Demand lookup that moves a hit out of the cache, as an exclusive
+//level does when the level above takes the block. A miss allocates
+//nothing here but still counts a read from the next level.
+//Sets *dirty if the block that left was dirty.
+uint32_t modelExtract(cacheModel *model, addr_t address, uint32_t *dirty){
+    uint32_t ways = model->ways;
+    model->numAccesses++;
+    model->evicted = 0;
+    model->lastLine = NULL;
+
+    addr_t tagBits = extractBitSequence(address,ADDR_BITS-model->numTagBits,model->numTagBits);
+    uint32_t indexBits = extractBitSequence(address,model->numOffsetBits,model->numIndexBits);
+    addr_t currentDataBlock = extractBitSequence(address,model->numOffsetBits,ADDR_BITS-model->numOffsetBits);
+    cacheLine *set = model->lines + (size_t)indexBits * ways;
+
+    uint32_t fullyAssocHitStatus = shadowAccess(&model->fullyAssocCache, currentDataBlock);
+    uint32_t selectedWay = modelFindWay(model, set, LINE_KEY(tagBits));
+
+    *dirty = 0;
+    if (selectedWay < ways){
+        model->totalHits++;
+        *dirty = set[selectedWay].flags & LINE_DIRTY;
+        memset(&set[selectedWay], 0, sizeof(cacheLine));
+        return HIT_SUCCESS;
+    }
+
+    model->totalMisses++;
+    model->readXactions++;
+    return modelClassifyMiss(model, currentDataBlock, fullyAssocHitStatus);
+}
+
+//Removes a block if present, as for back-invalidation
+//Returns -1 if it was not cached, else 1 if it was dirty and 0 if clean
+int modelInvalidate(cacheModel *model, addr_t address){
+    uint32_t ways = model->ways;
+    addr_t tagBits = extractBitSequence(address,ADDR_BITS-model->numTagBits,model->numTagBits);
+    uint32_t indexBits = extractBitSequence(address,model->numOffsetBits,model->numIndexBits);
+    cacheLine *set = model->lines + (size_t)indexBits * ways;
+
+    uint32_t selectedWay = modelFindWay(model, set, LINE_KEY(tagBits));
+    if (selectedWay == ways){
+        return -1;
+    }
+    int dirty = (set[selectedWay].flags & LINE_DIRTY) != 0;
+    memset(&set[selectedWay], 0, sizeof(cacheLine));
+    model->invalidations++;
+    model->lastLine = NULL;
+    return dirty;
+}
+
+//Marks a cached block dirty, if present
+void modelMarkDirty(cacheModel *model, addr_t address){
+    uint32_t ways = model->ways;
+    addr_t tagBits = extractBitSequence(address,ADDR_BITS-model->numTagBits,model->numTagBits);
+    uint32_t indexBits = extractBitSequence(address,model->numOffsetBits,model->numIndexBits);
+    cacheLine *set = model->lines + (size_t)indexBits * ways;
+
+    uint32_t selectedWay = modelFindWay(model, set, LINE_KEY(tagBits));
+    if (selectedWay < ways){
+        set[selectedWay].flags |= LINE_DIRTY;
+    }
+}
+
+//Returns the flags of a cached block, or -1 if it is not cached
+//Touches no replacement state, as for a snoop
+int modelProbe(cacheModel *model, addr_t address){
+    uint32_t ways = model->ways;
+    addr_t tagBits = extractBitSequence(address,ADDR_BITS-model->numTagBits,model->numTagBits);
+    uint32_t indexBits = extractBitSequence(address,model->numOffsetBits,model->numIndexBits);
+    cacheLine *set = model->lines + (size_t)indexBits * ways;
+
+    uint32_t selectedWay = modelFindWay(model, set, LINE_KEY(tagBits));
+    return selectedWay < ways ? (int) set[selectedWay].flags : -1;
+}
+
+//Sets, then clears, flags of a cached block; does nothing if it is not cached
+void modelSetFlags(cacheModel *model, addr_t address, uint32_t setFlags, uint32_t clearFlags){
+    uint32_t ways = model->ways;
+    addr_t tagBits = extractBitSequence(address,ADDR_BITS-model->numTagBits,model->numTagBits);
+    uint32_t indexBits = extractBitSequence(address,model->numOffsetBits,model->numIndexBits);
+    cacheLine *set = model->lines + (size_t)indexBits * ways;
+
+    uint32_t selectedWay = modelFindWay(model, set, LINE_KEY(tagBits));
+    if (selectedWay < ways){
+        set[selectedWay].flags = (set[selectedWay].flags | setFlags) & ~clearFlags;
+    }
+}
+
+//Print out the parameters of the cache
+void modelPrintHeader(const cacheModel *model, FILE *stream){
+    fprintf(stream, "Ways: %u; Sets: %u; Line Size: %uB\n", model->ways, model->numSets, model->line);
+    fprintf(stream, "Tag: %d bits; Index: %d bits; Offset: %d bits\n", model->numTagBits, model->numIndexBits, model->numOffsetBits);
+}
+
+//Print the results of the simulation
+void modelPrintStats(const cacheModel *model, FILE *stream){
+    fprintf(stream, "Miss Rate: %8lf%%\n", ((double) model->totalMisses) / ((double) model->totalMisses + (double) model->totalHits) * 100.0);
+    fprintf(stream, "Read Transactions: %" PRIu64 "\n", model->readXactions);
+    //Entries still in the write buffer go to memory when the program ends
+    uint32_t pendingWrites = model->writeBuf != NULL ? model->writeBuf->count : 0;
+    fprintf(stream, "Write Transactions: %" PRIu64 "\n", model->writeXactions + pendingWrites);
+
+    //Prefetch accounting, kept apart from the GOLD lines above
+    const prefetcher *pf = model->prefetch;
+    if (pf != NULL){
+        uint64_t eliminated = pf->useful + model->totalMisses;
+        fprintf(stream, "Prefetcher: %s (degree %u)\n", prefetchName(pf->kind), pf->degree);
+        fprintf(stream, "Prefetch Transactions: %" PRIu64 "\n", pf->issued);
+        fprintf(stream, "Useful Prefetches: %" PRIu64 " (accuracy %.2f%%, coverage %.2f%%)\n", pf->useful,
+                pf->issued ? (double) pf->useful / pf->issued * 100.0 : 0.0,
+                eliminated ? (double) pf->useful / eliminated * 100.0 : 0.0);
+        fprintf(stream, "Unused Prefetches: %" PRIu64 "; Redundant: %" PRIu64 "; Pollution Misses: %" PRIu64 "\n",
+                pf->unused, pf->redundant, pf->pollutionMisses);
+    }
+
+    //Conflict-miss mitigations and what they cost in tag comparisons
+    const victimCache *vc = model->victims;
+    if (vc != NULL){
+        fprintf(stream, "Victim Cache: %u entries; %" PRIu64 " hits (%" PRIu64 " conflict misses removed, %" PRIu64 " capacity); %" PRIu64 " writebacks\n",
+                vc->numEntries, vc->hits, vc->conflictRemoved, vc->capacityRemoved, vc->writebacks);
+    }
+    const wayPredictor *wp = model->wayPredict;
+    if (wp != NULL){
+        fprintf(stream, "Way Prediction: %s; %" PRIu64 " of %" PRIu64 " hits predicted (accuracy %.2f%%)\n", waypredName(wp->kind),
+                wp->correct, wp->predictions, wp->predictions ? (double) wp->correct / wp->predictions * 100.0 : 0.0);
+    }
+    if (vc != NULL || wp != NULL){
+        uint64_t baseline = model->numAccesses * model->ways;
+        //Probing the victim cache can cost more than it saves
+        uint32_t saved = model->tagCompares <= baseline;
+        fprintf(stream, "Tag Comparisons: %" PRIu64 " (%" PRIu64 " comparing every way; %" PRIu64 " %s)\n", model->tagCompares, baseline,
+                saved ? baseline - model->tagCompares : model->tagCompares - baseline, saved ? "saved" : "extra");
+    }
+
+    //Traffic depends on the write policy and prefetcher, so show it whenever either is in play
+    if (pf != NULL || !modelDefaultWrites(model)){
+        modelPrintTraffic(model, stream);
+    }
+}
+
+//Print the bytes moved between the cache and memory
+void modelPrintTraffic(const cacheModel *model, FILE *stream){
+    const prefetcher *pf = model->prefetch;
+    uint64_t demandReads = (model->readXactions - model->storeFills) * model->line;
+    uint64_t storeFills = model->storeFills * model->line;
+    uint64_t prefetchFills = pf != NULL ? pf->issued * model->line : 0;
+    uint64_t pendingBytes = model->writeBuf != NULL ? writeBufferPendingBytes(model->writeBuf) : 0;
+    uint64_t writeBytes = model->writeBytes + pendingBytes;
+
+    fprintf(stream, "Write Policy: %s, %s\n", model->writePolicy == WRITE_THROUGH ? "write-through" : "write-back",
+            model->writeAllocate ? "write-allocate" : "no-write-allocate");
+    fprintf(stream, "Memory Traffic: %" PRIu64 " bytes (reads %" PRIu64 ", writes %" PRIu64 ")\n",
+            demandReads + storeFills + prefetchFills + writeBytes, demandReads + storeFills + prefetchFills, writeBytes);
+    fprintf(stream, "Read Traffic: demand reads %" PRIu64 " bytes, store fills %" PRIu64 " bytes, prefetch fills %" PRIu64 " bytes\n",
+            demandReads, storeFills, prefetchFills);
+    fprintf(stream, "Write Traffic: writebacks %" PRIu64 " (%" PRIu64 " bytes), stores to memory %" PRIu64 " (%" PRIu64 " bytes)\n",
+            model->writebacks, model->writebacks * model->line, model->storeWrites, model->storeWrites * STORE_BYTES);
+    const writeBuffer *wb = model->writeBuf;
+    if (wb != NULL){
+        fprintf(stream, "Write Buffer: %u entries; %" PRIu64 " writes, %" PRIu64 " coalesced; %" PRIu64 " drained (%" PRIu64 " bytes), %u pending (%" PRIu64 " bytes)\n",
+                wb->capacity, wb->writes, wb->coalesced, wb->drains, wb->drainedBytes, wb->count, pendingBytes);
+    }
+}
+
+//Print statistics beyond the GOLD format, requested with -stats
+void modelPrintExtraStats(const cacheModel *model, FILE *stream){
+    uint64_t uniqueBlocks = model->touchedBlocks.numBlocks;
+    fprintf(stream, "Unique Blocks: %llu (%llu KB footprint)\n", (unsigned long long) uniqueBlocks,
+            (unsigned long long) (uniqueBlocks * model->line / 1024));
+    if (model->prefetch == NULL && modelDefaultWrites(model)){
+        modelPrintTraffic(model, stream);
+    }
+}
+
+//Zeroes the statistics but keeps the cache contents, so a warmed-up
+//cache is measured from here on
+void modelResetStats(cacheModel *model){
+    model->numAccesses = 0;
+    model->totalHits = 0;
+    model->totalMisses = 0;
+    model->readXactions = 0;
+    model->writeXactions = 0;
+    model->storeFills = 0;
+    model->writebacks = 0;
+    model->storeWrites = 0;
+    model->writeBytes = 0;
+    model->compulsoryMisses = 0;
+    model->capacityMisses = 0;
+    model->conflictMisses = 0;
+    model->installs = 0;
+    model->invalidations = 0;
+    if (model->setCounts != NULL){
+        memset(model->setCounts, 0, (size_t)model->numSets * sizeof(setCounters));
+    }
+    if (model->prefetch != NULL){
+        model->prefetch->issued = 0;
+        model->prefetch->useful = 0;
+        model->prefetch->unused = 0;
+        model->prefetch->redundant = 0;
+        model->prefetch->pollutionMisses = 0;
+    }
+    if (model->victims != NULL){
+        model->victims->hits = 0;
+        model->victims->conflictRemoved = 0;
+        model->victims->capacityRemoved = 0;
+        model->victims->insertions = 0;
+        model->victims->writebacks = 0;
+    }
+    if (model->wayPredict != NULL){
+        model->wayPredict->predictions = 0;
+        model->wayPredict->correct = 0;
+    }
+    model->tagCompares = 0;
+    if (model->writeBuf != NULL){
+        model->writeBuf->writes = 0;
+        model->writeBuf->coalesced = 0;
+        model->writeBuf->drains = 0;
+        model->writeBuf->drainedBytes = 0;
+    }
+}
+
+//Saves everything the next access depends on, and the statistics so far:
+//tag store, replacement state, shadow cache, touched blocks, prefetcher, write buffer,
+//victim cache and way predictor.
+//The configuration is the caller's to record. Returns 0 on success
+int modelWrite(const cacheModel *model, FILE *file){
+    uint64_t state[18] = { model->ageClock, model->psel, model->randomState,
+                           model->numAccesses, model->totalHits, model->totalMisses,
+                           model->readXactions, model->writeXactions, model->compulsoryMisses,
+                           model->capacityMisses, model->conflictMisses, model->installs, model->invalidations,
+                           model->storeFills, model->writebacks, model->storeWrites, model->writeBytes,
+                           model->tagCompares };
+    size_t numLines = (size_t)model->numSets * model->ways;
+    if (fwrite(state, sizeof(state), 1, file) != 1 || fwrite(model->lines, sizeof(cacheLine), numLines, file) != numLines){
+        return -1;
+    }
+    if (model->treeBits != NULL && fwrite(model->treeBits, sizeof(uint64_t), model->numSets, file) != model->numSets){
+        return -1;
+    }
+    if (shadowWrite(&model->fullyAssocCache, file) || blockSetWrite(&model->touchedBlocks, file)){
+        return -1;
+    }
+    if (model->prefetch != NULL && prefetchWrite(model->prefetch, file)){
+        return -1;
+    }
+    if (model->writeBuf != NULL && writeBufferWrite(model->writeBuf, file)){
+        return -1;
+    }
+    if (model->victims != NULL && victimWrite(model->victims, file)){
+        return -1;
+    }
+    return model->wayPredict != NULL ? waypredWrite(model->wayPredict, file) : 0;
+}
+
+//Loads modelWrite's output into a freshly initialized model of the same
+//configuration (prefetcher and write policy included). Returns 0 on success
+int modelRead(cacheModel *model, FILE *file){
+    uint64_t state[18];
+    size_t numLines = (size_t)model->numSets * model->ways;
+    if (fread(state, sizeof(state), 1, file) != 1 || fread(model->lines, sizeof(cacheLine), numLines, file) != numLines){
+        return -1;
+    }
+    if (model->treeBits != NULL && fread(model->treeBits, sizeof(uint64_t), model->numSets, file) != model->numSets){
+        return -1;
+    }
+    if (shadowRead(&model->fullyAssocCache, file) || blockSetRead(&model->touchedBlocks, file)){
+        return -1;
+    }
+    if (model->prefetch != NULL && prefetchRead(model->prefetch, file)){
+        return -1;
+    }
+    if (model->writeBuf != NULL && writeBufferRead(model->writeBuf, file)){
+        return -1;
+    }
+    if (model->victims != NULL && victimRead(model->victims, file)){
+        return -1;
+    }
+    if (model->wayPredict != NULL && waypredRead(model->wayPredict, file)){
+        return -1;
+    }
+    model->lastLine = NULL;
+    model->ageClock = state[0];
+    model->psel = state[1];
+    model->randomState = state[2];
+    model->numAccesses = state[3];
+    model->totalHits = state[4];
+    model->totalMisses = state[5];
+    model->readXactions = state[6];
+    model->writeXactions = state[7];
+    model->compulsoryMisses = state[8];
+    model->capacityMisses = state[9];
+    model->conflictMisses = state[10];
+    model->installs = state[11];
+    model->invalidations = state[12];
+    model->storeFills = state[13];
+    model->writebacks = state[14];
+    model->storeWrites = state[15];
+    model->writeBytes = state[16];
+    model->tagCompares = state[17];
+    return 0;
+}
+
+//Divides the shadow cache's capacity by 'ratio'. When only 1 in ratio
+//sets are simulated, the shadow sees about 1 in ratio of the blocks,
+//so it must hold that share of the capacity to split misses the same way.
+int modelScaleShadow(cacheModel *model, uint32_t ratio){
+    uint64_t numBlocks = (uint64_t)model->numSets * model->ways / ratio;
+    model->lastLine = NULL;
+    shadowFree(&model->fullyAssocCache);
+    return shadowInit(&model->fullyAssocCache, numBlocks ? numBlocks : 1, model->replacementPolicy == FIFO ? FIFO : LRU);
+}
+
+void modelFree(cacheModel *model){
+    free(model->lines);
+    free(model->setCounts);
+    prefetchFree(model->prefetch);
+    writeBufferFree(model->writeBuf);
+    victimFree(model->victims);
+    waypredFree(model->wayPredict);
+    free(model->treeBits);
+    blockSetFree(&model->touchedBlocks);
+    shadowFree(&model->fullyAssocCache);
+}
+
+const char *modelPolicyName(uint32_t policy){
+    return policy < NUM_POLICIES ? policyNames[policy] : "unknown";
+}
+
+//Returns the policy with this name, or -1
+int modelPolicyParse(const char *name){
+    for (int policy = 0; policy < NUM_POLICIES; policy++){
+        if (!strcmp(name, policyNames[policy])){
+            return policy;
+        }
+    }
+    return -1;
+}
+
+/////////////////////////////////////////////////////
+// End of file
+/////////////////////////////////////////////////////
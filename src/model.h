@@ -0,0 +1,158 @@
+/////////////////////////////////////////////////////
+// CSC 252 Project 4
+// Cache Simulator
+// Wilfred Wallis and Chris Dalke
+/////////////////////////////////////////////////////
+// File: model.h
+/////////////////////////////////////////////////////
+
+#ifndef MODEL_H
+#define MODEL_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include "cache.h"
+#include "trace.h"
+#include "shadow.h"
+#include "blockset.h"
+#include "tagstore.h"
+#include "prefetch.h"
+#include "writebuf.h"
+#include "victim.h"
+#include "waypred.h"
+
+//Write hit policies
+#define WRITE_BACK 0       //stores dirty the line; it is written when evicted
+#define WRITE_THROUGH 1    //stores go on to memory; lines stay clean
+
+//Traces carry no access size, so a store is taken to write one 32-bit word
+#define STORE_BYTES 4
+
+//Per-set counters, kept only when modelTrackSets asks for them
+typedef struct {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+    uint64_t writebacks;        //dirty evictions
+} setCounters;
+
+//One simulated cache: configuration, state and statistics
+typedef struct {
+    //Configuration
+    uint32_t size;              //total size (KB)
+    uint32_t ways;
+    uint32_t line;              //line size (B)
+    uint32_t replacementPolicy;
+    uint32_t writePolicy;       //WRITE_BACK or WRITE_THROUGH
+    uint32_t writeAllocate;     //store misses fill the line; without it they go around the cache
+
+    //Derived attributes
+    uint32_t numSets;
+    uint32_t numIndexBits;
+    uint32_t numOffsetBits;
+    uint32_t numTagBits;
+
+    //Tag store, indexed [set * ways + way], so each set is contiguous
+    cacheLine *lines;
+
+    //Set search kernels for this associativity and CPU
+    tagSearch search;
+
+    //Blocks that have ever been loaded, for compulsory misses
+    blockSet touchedBlocks;
+
+    //Fully-associative shadow cache for conflict vs capacity
+    shadowCache fullyAssocCache;
+
+    //Replacement stamps. Ages only matter relative to others in their set,
+    //so when the clock runs out each set is renumbered from 1.
+    uint32_t ageClock;
+
+    //Sets this model simulates: setFirst, setFirst + setStride, ...
+    //All of them unless it is a shard of another model
+    uint32_t setFirst;
+    uint32_t setStride;
+
+    //Replacement policy state
+    uint64_t *treeBits;         //PLRU tree per set, bit n is node n of the heap
+    uint32_t psel;              //DRRIP policy selector: high favors BRRIP
+    uint64_t randomState;       //xorshift state for RANDOM and BRRIP
+
+    //Statistics
+    uint64_t numAccesses;
+    uint64_t totalHits;
+    uint64_t totalMisses;
+    uint64_t readXactions;      //lines filled on demand, for loads and allocating stores
+    uint64_t writeXactions;     //writes that reached memory
+    uint64_t storeFills;        //readXactions caused by store misses
+    uint64_t writebacks;        //dirty lines evicted
+    uint64_t storeWrites;       //stores written through, or around the cache
+    uint64_t writeBytes;        //bytes that reached memory
+    uint64_t compulsoryMisses;
+    uint64_t capacityMisses;
+    uint64_t conflictMisses;
+    uint64_t installs;          //blocks put in by writebacks or victims from above
+    uint64_t invalidations;     //blocks removed by back-invalidation
+    setCounters *setCounts;     //one per set, or NULL when not tracked
+
+    //Prefetcher, or NULL for demand fetching only
+    prefetcher *prefetch;
+
+    //Buffer in front of memory, or NULL to write at once
+    writeBuffer *writeBuf;
+
+    //Conflict-miss mitigations, or NULL
+    victimCache *victims;       //catches blocks the cache evicts
+    wayPredictor *wayPredict;   //guesses the hitting way before the tag search
+    uint64_t tagCompares;       //tag comparisons made, counted while either is attached
+
+    //Line the previous access left its block in, for the repeat fast path;
+    //NULL when anything else may have moved blocks since
+    cacheLine *lastLine;
+    addr_t lastBlock;
+    uint32_t lastSet;
+
+    //Block evicted by the last access or install, if any
+    uint32_t evicted;
+    uint32_t evictedDirty;
+    addr_t evictedAddress;
+} cacheModel;
+
+int modelInit(cacheModel *model, uint32_t size, uint32_t ways, uint32_t line, uint32_t replacementPolicy);
+void modelSeed(cacheModel *model, uint64_t seed);
+int modelTrackSets(cacheModel *model);
+int modelSetPrefetcher(cacheModel *model, uint32_t kind, uint32_t degree);
+int modelSetWritePolicy(cacheModel *model, uint32_t writePolicy, uint32_t writeAllocate, uint32_t bufferEntries);
+int modelDefaultWrites(const cacheModel *model);
+int modelSetVictimCache(cacheModel *model, uint32_t numEntries);
+int modelSetWayPredictor(cacheModel *model, uint32_t kind);
+uint32_t modelAccess(cacheModel *model, addr_t address, uint32_t isStore);
+void modelAccessBatch(cacheModel *model, const traceRecord *records, uint32_t count, uint8_t *outcomes);
+void modelAccessRuns(cacheModel *model, const traceRecord *records, const traceRun *runs, uint32_t numRuns, uint8_t *outcomes);
+int modelShardable(uint32_t policy);
+int modelShardInit(cacheModel *shard, const cacheModel *owner, uint32_t shardIndex, uint32_t numShards);
+void modelAccessShard(cacheModel *shard, const traceRecord *records, uint64_t count, uint8_t *outcomes);
+void modelShardFree(cacheModel *shard);
+void modelInstall(cacheModel *model, addr_t address, uint32_t dirty);
+uint32_t modelExtract(cacheModel *model, addr_t address, uint32_t *dirty);
+int modelInvalidate(cacheModel *model, addr_t address);
+void modelMarkDirty(cacheModel *model, addr_t address);
+int modelProbe(cacheModel *model, addr_t address);
+void modelSetFlags(cacheModel *model, addr_t address, uint32_t setFlags, uint32_t clearFlags);
+void modelPrintHeader(const cacheModel *model, FILE *stream);
+void modelPrintStats(const cacheModel *model, FILE *stream);
+void modelPrintExtraStats(const cacheModel *model, FILE *stream);
+void modelPrintTraffic(const cacheModel *model, FILE *stream);
+void modelResetStats(cacheModel *model);
+int modelWrite(const cacheModel *model, FILE *file);
+int modelRead(cacheModel *model, FILE *file);
+int modelScaleShadow(cacheModel *model, uint32_t ratio);
+void modelFree(cacheModel *model);
+const char *modelPolicyName(uint32_t policy);
+int modelPolicyParse(const char *name);
+
+#endif
+
+/////////////////////////////////////////////////////
+// End of file
+/////////////////////////////////////////////////////
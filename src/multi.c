@@ -0,0 +1,324 @@
+/////////////////////////////////////////////////////
+// CSC 252 Project 4
+// Cache Simulator
+// Wilfred Wallis and Chris Dalke
+/////////////////////////////////////////////////////
+// File: multi.c
+/////////////////////////////////////////////////////
+
+#include "cache.h"
+#include "trace.h"
+#include "model.h"
+#include "pool.h"
+#include "multi.h"
+
+/////////////////////////////////////////////////////
+// Multi-configuration simulation
+//
+// The trace is parsed once into memory, then every
+// configuration is simulated as an independent task on
+// the work-stealing pool. Each task owns its model and
+// its .simulated file; stats are printed in the order
+// the configurations were given.
+/////////////////////////////////////////////////////
+
+typedef struct {
+    cacheConfig config;
+    cacheModel model;
+    int failed;           //model could not be allocated
+    const traceRecord *records;
+    uint64_t numRecords;
+    char *outputFilename;
+    uint32_t outputMode;
+} multiJob;
+
+/////////////////////////////////////////////////////
+// Configuration parsing
+// configParse: reads "size:ways:line[:option...]"
+// configLoadFile: reads one "size ways line [option...]" per line
+//
+// Options are a replacement policy (fifo, lru, plru, srrip,
+// brrip, drrip, random), a seed for the randomized ones
+// (seed=N), a prefetcher (nextline, stride, stream) and
+// its degree (degree=N), write handling (writethrough,
+// noallocate, wbuf=N entries), a victim cache (victim=N),
+// a way predictor (waypredict=mru|hash) and, for hierarchy levels
+// (isLevel), an inclusion policy (nine, inclusive, exclusive).
+// Elsewhere an inclusion policy is an error, since it would
+// be silently ignored.
+/////////////////////////////////////////////////////
+
+int configParse(const char *text, cacheConfig *config, uint32_t isLevel){
+    char options[128] = "";
+    int fields = sscanf(text, "%u:%u:%u:%127s", &config->size, &config->ways, &config->line, options);
+    if (fields < 3 || config->size == 0 || config->ways == 0 || config->line == 0){
+        return -1;
+    }
+
+    config->replacementPolicy = FIFO;
+    config->inclusion = INCLUSION_NINE;
+    config->seed = 1;
+    config->prefetcher = PREFETCH_NONE;
+    config->prefetchDegree = 0;
+    config->writePolicy = WRITE_BACK;
+    config->writeAllocate = 1;
+    config->writeBufferEntries = 0;
+    config->victimEntries = 0;
+    config->wayPredictor = WAYPRED_NONE;
+    for (char *option = strtok(options, ":"); option != NULL; option = strtok(NULL, ":")){
+        int policy = modelPolicyParse(option);
+        int prefetch = prefetchParse(option);
+        if (policy >= 0){
+            config->replacementPolicy = policy;
+        } else if (prefetch >= 0){
+            config->prefetcher = prefetch;
+        } else if (!strncmp(option, "degree=", 7) && isdigit(option[7])){
+            config->prefetchDegree = strtoul(option + 7, NULL, 10);
+        } else if (!strcmp(option, "writethrough")){
+            config->writePolicy = WRITE_THROUGH;
+        } else if (!strcmp(option, "noallocate")){
+            config->writeAllocate = 0;
+        } else if (!strncmp(option, "wbuf=", 5) && isdigit(option[5])){
+            config->writeBufferEntries = strtoul(option + 5, NULL, 10);
+        } else if (!strncmp(option, "victim=", 7) && isdigit(option[7])){
+            config->victimEntries = strtoul(option + 7, NULL, 10);
+        } else if (!strncmp(option, "waypredict=", 11) && waypredParse(option + 11) > WAYPRED_NONE){
+            config->wayPredictor = waypredParse(option + 11);
+        } else if (!strncmp(option, "seed=", 5) && isdigit(option[5])){
+            config->seed = strtoull(option + 5, NULL, 10);
+        } else if (!isLevel){
+            return -1;
+        } else if (!strcmp(option, "nine")){
+            config->inclusion = INCLUSION_NINE;
+        } else if (!strcmp(option, "inclusive")){
+            config->inclusion = INCLUSION_INCLUSIVE;
+        } else if (!strcmp(option, "exclusive")){
+            config->inclusion = INCLUSION_EXCLUSIVE;
+        } else {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int configLoadFile(const char *filename, cacheConfig **configs, uint32_t *numConfigs, uint32_t isLevel){
+    FILE *file = fopen(filename, "r");
+    if (file == NULL){
+        return -1;
+    }
+
+    char line[256];
+    char text[256];
+    while (fgets(line, sizeof(line), file) != NULL){
+        //Reuse the command line syntax by joining the fields with ':'
+        uint32_t length = 0;
+        for (char *field = strtok(line, " \t\r\n"); field != NULL; field = strtok(NULL, " \t\r\n")){
+            if (field[0] == '#'){
+                break;
+            }
+            length += snprintf(text + length, sizeof(text) - length, "%s%s", length ? ":" : "", field);
+            if (length >= sizeof(text)){
+                fclose(file);
+                return -1;
+            }
+        }
+
+        //Skip blank lines and comments
+        if (length == 0){
+            continue;
+        }
+
+        *configs = realloc(*configs, sizeof(cacheConfig) * (*numConfigs + 1));
+        if (configParse(text, &(*configs)[*numConfigs], isLevel)){
+            fclose(file);
+            return -1;
+        }
+        (*numConfigs)++;
+    }
+
+    fclose(file);
+    return 0;
+}
+
+//Filename suffix for a policy, e.g. "_LRU"; FIFO, the default, has none
+static void multiPolicySuffix(uint32_t policy, char *suffix){
+    const char *name = policy == FIFO ? "" : modelPolicyName(policy);
+    *suffix++ = *name ? '_' : '\0';
+    while (*name){
+        *suffix++ = toupper(*name++);
+    }
+    *suffix = '\0';
+}
+
+//Whether a policy draws on the seed, so the seed belongs in the filename
+static int multiSeeded(uint32_t policy){
+    return policy == RANDOM || policy == BRRIP || policy == DRRIP;
+}
+
+//Simulates one configuration over the shared records
+static void multiRunJob(void *arg){
+    multiJob *job = arg;
+    if (modelInit(&job->model, job->config.size, job->config.ways, job->config.line, job->config.replacementPolicy)){
+        job->failed = 1;
+        return;
+    }
+    modelSeed(&job->model, job->config.seed);
+    if (modelSetPrefetcher(&job->model, job->config.prefetcher, job->config.prefetchDegree)
+        || modelSetWritePolicy(&job->model, job->config.writePolicy, job->config.writeAllocate, job->config.writeBufferEntries)
+        || modelSetVictimCache(&job->model, job->config.victimEntries)
+        || modelSetWayPredictor(&job->model, job->config.wayPredictor)){
+        modelFree(&job->model);
+        job->failed = 1;
+        return;
+    }
+
+    resultWriter writer;
+    if (outputOpen(&writer, job->outputFilename, job->outputMode)){
+        fprintf(stderr, "Could not open %s\n", job->outputFilename);
+        outputOpen(&writer, NULL, OUTPUT_NONE);
+    }
+
+    //Simulate in batches so the writer sees a run of outcomes at a time
+    uint8_t outcomes[TRACE_BATCH_SIZE];
+    for (uint64_t start = 0; start < job->numRecords; start += TRACE_BATCH_SIZE){
+        uint32_t count = job->numRecords - start < TRACE_BATCH_SIZE ? job->numRecords - start : TRACE_BATCH_SIZE;
+        const traceRecord *records = job->records + start;
+        modelAccessBatch(&job->model, records, count, outcomes);
+        outputWriteBatch(&writer, records, outcomes, count);
+    }
+
+    outputClose(&writer);
+}
+
+int runMulti(char *filename, const cacheConfig *configs, uint32_t numConfigs, uint32_t numThreads, uint32_t outputMode, uint32_t extraStats){
+    uint64_t numRecords;
+    traceRecord *records = traceLoad(filename, &numRecords);
+    if (records == NULL){
+        printf("Could not open trace file\n");
+        return -1;
+    }
+
+    multiJob *jobs = calloc(numConfigs, sizeof(multiJob));
+    void **args = malloc(sizeof(void *) * numConfigs);
+    for (uint32_t c = 0; c < numConfigs; c++){
+        jobs[c].config = configs[c];
+        jobs[c].records = records;
+        jobs[c].numRecords = numRecords;
+        //e.g. trace.s32_w2_l64_LRU.simulated
+        jobs[c].outputMode = outputMode;
+        char suffix[64];
+        multiPolicySuffix(configs[c].replacementPolicy, suffix);
+        if (multiSeeded(configs[c].replacementPolicy)){
+            sprintf(suffix + strlen(suffix), "_S%llu", (unsigned long long) configs[c].seed);
+        }
+        if (configs[c].prefetcher != PREFETCH_NONE){
+            //e.g. _LRU_STRIDE, so configurations differing only there don't share a file
+            char *end = suffix + strlen(suffix);
+            *end++ = '_';
+            for (const char *name = prefetchName(configs[c].prefetcher); *name; name++){
+                *end++ = toupper(*name);
+            }
+            *end = '\0';
+            if (configs[c].prefetchDegree){
+                sprintf(end, "_D%u", configs[c].prefetchDegree);
+            }
+        }
+        if (configs[c].writePolicy == WRITE_THROUGH){
+            strcat(suffix, "_WT");
+        }
+        if (!configs[c].writeAllocate){
+            strcat(suffix, "_NWA");
+        }
+        if (configs[c].writeBufferEntries){
+            sprintf(suffix + strlen(suffix), "_WB%u", configs[c].writeBufferEntries);
+        }
+        if (configs[c].victimEntries){
+            sprintf(suffix + strlen(suffix), "_V%u", configs[c].victimEntries);
+        }
+        if (configs[c].wayPredictor != WAYPRED_NONE){
+            char *end = suffix + strlen(suffix);
+            *end++ = '_';
+            for (const char *name = waypredName(configs[c].wayPredictor); *name; name++){
+                *end++ = toupper(*name);
+            }
+            *end = '\0';
+        }
+        jobs[c].outputFilename = malloc(strlen(traceResultBase(filename)) + 96);
+        sprintf(jobs[c].outputFilename, "%s.s%u_w%u_l%u%s%s", traceResultBase(filename), configs[c].size, configs[c].ways,
+                configs[c].line, suffix, outputExtension(outputMode));
+        args[c] = &jobs[c];
+    }
+
+    //Two jobs sharing a results file would write it at the same time
+    for (uint32_t c = 0; c < numConfigs; c++){
+        for (uint32_t d = 0; d < c; d++){
+            if (!strcmp(jobs[c].outputFilename, jobs[d].outputFilename)){
+                printf("Configurations %u and %u are the same (both would write %s)\n", d + 1, c + 1, jobs[c].outputFilename);
+                for (uint32_t j = 0; j < numConfigs; j++){
+                    free(jobs[j].outputFilename);
+                }
+                free(args);
+                free(jobs);
+                free(records);
+                return -1;
+            }
+        }
+    }
+
+    poolRun(multiRunJob, args, numConfigs, numThreads);
+
+    //Report in the order given, one GOLD-format block per configuration
+    for (uint32_t c = 0; c < numConfigs; c++){
+        printf("Config: -s %u -w %u -l %u", configs[c].size, configs[c].ways, configs[c].line);
+        if (configs[c].replacementPolicy == LRU){
+            printf(" -lru");
+        } else if (configs[c].replacementPolicy != FIFO){
+            printf(" -policy %s", modelPolicyName(configs[c].replacementPolicy));
+        }
+        if (multiSeeded(configs[c].replacementPolicy)){
+            printf(" -seed %llu", (unsigned long long) configs[c].seed);
+        }
+        if (configs[c].prefetcher != PREFETCH_NONE){
+            printf(" -prefetch %s", prefetchName(configs[c].prefetcher));
+            if (configs[c].prefetchDegree){
+                printf(" -prefetch-degree %u", configs[c].prefetchDegree);
+            }
+        }
+        if (configs[c].writePolicy == WRITE_THROUGH){
+            printf(" -write-through");
+        }
+        if (!configs[c].writeAllocate){
+            printf(" -no-write-allocate");
+        }
+        if (configs[c].writeBufferEntries){
+            printf(" -write-buffer %u", configs[c].writeBufferEntries);
+        }
+        if (configs[c].victimEntries){
+            printf(" -victim %u", configs[c].victimEntries);
+        }
+        if (configs[c].wayPredictor != WAYPRED_NONE){
+            printf(" -way-predict %s", waypredName(configs[c].wayPredictor));
+        }
+        printf("\n");
+        if (jobs[c].failed){
+            printf("Could not set up a cache with these parameters\n");
+        } else {
+            modelPrintHeader(&jobs[c].model, stdout);
+            modelPrintStats(&jobs[c].model, stdout);
+            if (extraStats){
+                modelPrintExtraStats(&jobs[c].model, stdout);
+            }
+            modelFree(&jobs[c].model);
+        }
+        free(jobs[c].outputFilename);
+    }
+
+    free(args);
+    free(jobs);
+    free(records);
+    return 0;
+}
+
+/////////////////////////////////////////////////////
+// End of file
+/////////////////////////////////////////////////////
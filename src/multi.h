@@ -0,0 +1,44 @@
+/////////////////////////////////////////////////////
+// CSC 252 Project 4
+// Cache Simulator
+// Wilfred Wallis and Chris Dalke
+/////////////////////////////////////////////////////
+// File: multi.h
+/////////////////////////////////////////////////////
+
+#ifndef MULTI_H
+#define MULTI_H
+
+#include <stdint.h>
+
+//How a hierarchy level relates to the levels above it
+#define INCLUSION_NINE 0       //non-inclusive non-exclusive
+#define INCLUSION_INCLUSIVE 1  //holds everything above; evictions back-invalidate
+#define INCLUSION_EXCLUSIVE 2  //holds only victims of the level above
+
+//One (size, ways, line, policy) tuple to simulate
+typedef struct {
+    uint32_t size;
+    uint32_t ways;
+    uint32_t line;
+    uint32_t replacementPolicy;
+    uint32_t inclusion;         //only used for hierarchy levels
+    uint64_t seed;              //for the RANDOM and BRRIP/DRRIP policies
+    uint32_t prefetcher;        //PREFETCH_*
+    uint32_t prefetchDegree;    //0 for the prefetcher's default
+    uint32_t writePolicy;       //WRITE_BACK or WRITE_THROUGH
+    uint32_t writeAllocate;
+    uint32_t writeBufferEntries; //0 for no write buffer
+    uint32_t victimEntries;     //0 for no victim cache
+    uint32_t wayPredictor;      //WAYPRED_*
+} cacheConfig;
+
+int configParse(const char *text, cacheConfig *config, uint32_t isLevel);
+int configLoadFile(const char *filename, cacheConfig **configs, uint32_t *numConfigs, uint32_t isLevel);
+int runMulti(char *filename, const cacheConfig *configs, uint32_t numConfigs, uint32_t numThreads, uint32_t outputMode, uint32_t extraStats);
+
+#endif
+
+/////////////////////////////////////////////////////
+// End of file
+/////////////////////////////////////////////////////
@@ -0,0 +1,152 @@
+/////////////////////////////////////////////////////
+// CSC 252 Project 4
+// Cache Simulator
+// Wilfred Wallis and Chris Dalke
+/////////////////////////////////////////////////////
+// File: pipeline.c
+/////////////////////////////////////////////////////
+
+#include <pthread.h>
+#include "cache.h"
+#include "trace.h"
+#include "pool.h"
+#include "ring.h"
+#include "pipeline.h"
+
+/////////////////////////////////////////////////////
+// Reader / simulator / writer pipeline
+//
+// A fixed set of batches circulates through three rings:
+// the reader takes a free batch, parses records into it
+// and passes it on; the simulator fills in the outcomes;
+// the writer formats them and hands the batch back as
+// free. Each ring has one producer and one consumer, so
+// no locks are needed, and running out of free batches
+// is what holds the reader back when the others are slow.
+// An empty batch marks the end of the trace and is passed
+// down the line so every stage shuts down in order.
+/////////////////////////////////////////////////////
+
+typedef struct {
+    traceRecord *records;
+    uint8_t *outcomes;
+    uint32_t count; //0 marks the end of the trace
+} pipelineBatch;
+
+typedef struct {
+    spscRing freeBatches;  //writer -> reader
+    spscRing parsed;       //reader -> simulator
+    spscRing simulated;    //simulator -> writer
+    resultWriter *writer;
+} pipelineRings;
+
+//Reader stage: parses the open trace into free batches
+static void *pipelineReader(void *arg){
+    pipelineRings *rings = arg;
+    uint32_t count;
+    do {
+        pipelineBatch *batch = ringPop(&rings->freeBatches);
+        count = traceReadBatch(batch->records, TRACE_BATCH_SIZE);
+        batch->count = count;
+        ringPush(&rings->parsed, batch);
+    } while (count > 0);
+    return NULL;
+}
+
+//Writer stage: writes simulated batches and recycles them
+static void *pipelineWriter(void *arg){
+    pipelineRings *rings = arg;
+    for (;;){
+        pipelineBatch *batch = ringPop(&rings->simulated);
+        if (batch->count == 0){
+            return NULL;
+        }
+        outputWriteBatch(rings->writer, batch->records, batch->outcomes, batch->count);
+        ringPush(&rings->freeBatches, batch);
+    }
+}
+
+//Reads a -pipeline mode name; returns 0 on success
+int pipelineModeParse(const char *name, uint32_t *mode){
+    if (!strcmp(name, "auto")){
+        *mode = PIPELINE_AUTO;
+    } else if (!strcmp(name, "on")){
+        *mode = PIPELINE_ON;
+    } else if (!strcmp(name, "off")){
+        *mode = PIPELINE_OFF;
+    } else {
+        return -1;
+    }
+    return 0;
+}
+
+//Whether to run the stages on their own threads; automatic only pays off with spare processors
+uint32_t pipelineEnabled(uint32_t mode){
+    if (mode == PIPELINE_AUTO){
+        return poolDefaultThreads() > 1;
+    }
+    return mode == PIPELINE_ON;
+}
+
+//Streams the open trace through simulate into writer, the three overlapping; returns 0 on success
+int pipelineRun(pipelineStage simulate, void *context, resultWriter *writer){
+    pipelineRings rings;
+    pipelineBatch batches[PIPELINE_DEPTH];
+    pthread_t reader, writerThread;
+    int result = 0;
+
+    //Every ring can hold every batch, so pushes never wait
+    rings.writer = writer;
+    if (ringInit(&rings.freeBatches, PIPELINE_DEPTH) || ringInit(&rings.parsed, PIPELINE_DEPTH)
+        || ringInit(&rings.simulated, PIPELINE_DEPTH)){
+        return -1;
+    }
+    for (uint32_t b = 0; b < PIPELINE_DEPTH; b++){
+        batches[b].records = malloc(sizeof(traceRecord) * TRACE_BATCH_SIZE);
+        batches[b].outcomes = malloc(sizeof(uint8_t) * TRACE_BATCH_SIZE);
+        batches[b].count = 0;
+        ringPush(&rings.freeBatches, &batches[b]);
+    }
+
+    if (pthread_create(&reader, NULL, pipelineReader, &rings)){
+        result = -1;
+    } else {
+        //Without a writer thread the simulator writes each batch itself
+        uint32_t writeInline = pthread_create(&writerThread, NULL, pipelineWriter, &rings) != 0;
+
+        //Simulator stage on the calling thread
+        for (;;){
+            pipelineBatch *batch = ringPop(&rings.parsed);
+            if (batch->count > 0){
+                simulate(context, batch->records, batch->count, batch->outcomes);
+            }
+            if (!writeInline){
+                ringPush(&rings.simulated, batch);
+            } else if (batch->count > 0){
+                outputWriteBatch(writer, batch->records, batch->outcomes, batch->count);
+                ringPush(&rings.freeBatches, batch);
+            }
+            if (batch->count == 0){
+                break;
+            }
+        }
+
+        pthread_join(reader, NULL);
+        if (!writeInline){
+            pthread_join(writerThread, NULL);
+        }
+    }
+
+    for (uint32_t b = 0; b < PIPELINE_DEPTH; b++){
+        free(batches[b].records);
+        free(batches[b].outcomes);
+    }
+    ringFree(&rings.freeBatches);
+    ringFree(&rings.parsed);
+    ringFree(&rings.simulated);
+    return result;
+}
+
+/////////////////////////////////////////////////////
+// End of file
+/////////////////////////////////////////////////////
@@ -0,0 +1,34 @@
+/////////////////////////////////////////////////////
+// CSC 252 Project 4
+// Cache Simulator
+// Wilfred Wallis and Chris Dalke
+/////////////////////////////////////////////////////
+// File: pipeline.h
+/////////////////////////////////////////////////////
+
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <stdint.h>
+#include "trace.h"
+
+//Pipeline modes for -pipeline
+#define PIPELINE_AUTO 0
+#define PIPELINE_ON 1
+#define PIPELINE_OFF 2
+
+//Batches in flight between the three stages
+#define PIPELINE_DEPTH 8
+
+//Simulates one batch, filling in an outcome per record
+typedef void (*pipelineStage)(void *context, const traceRecord *records, uint32_t count, uint8_t *outcomes);
+
+int pipelineModeParse(const char *name, uint32_t *mode);
+uint32_t pipelineEnabled(uint32_t mode);
+int pipelineRun(pipelineStage simulate, void *context, resultWriter *writer);
+
+#endif
+
+/////////////////////////////////////////////////////
+// End of file
+/////////////////////////////////////////////////////
@@ -0,0 +1,121 @@
+/////////////////////////////////////////////////////
+// CSC 252 Project 4
+// Cache Simulator
+// Wilfred Wallis and Chris Dalke
+/////////////////////////////////////////////////////
+// File: pool.c
+/////////////////////////////////////////////////////
+
+#include <pthread.h>
+#include <unistd.h>
+#include "cache.h"
+#include "pool.h"
+
+/////////////////////////////////////////////////////
+// Work-stealing thread pool
+//
+// Tasks are dealt round-robin into one deque per worker.
+// A worker takes tasks from the bottom of its own deque;
+// once that is empty it steals from the top of the
+// others'. Tasks never spawn new tasks, so a worker is
+// done as soon as every deque is empty.
+/////////////////////////////////////////////////////
+
+typedef struct {
+    pthread_mutex_t lock;
+    uint32_t *tasks;  //task indices
+    uint32_t top;     //next task to steal
+    uint32_t bottom;  //one past the next task to pop
+} poolDeque;
+
+typedef struct {
+    poolTask task;
+    void **args;
+    poolDeque *deques;
+    uint32_t numThreads;
+    uint32_t self;
+} poolWorker;
+
+//Takes a task from one end of a deque; returns 0 if it was empty
+static int poolTake(poolDeque *deque, int steal, uint32_t *taskIndex){
+    int found = 0;
+    pthread_mutex_lock(&deque->lock);
+    if (deque->top < deque->bottom){
+        *taskIndex = steal ? deque->tasks[deque->top++] : deque->tasks[--deque->bottom];
+        found = 1;
+    }
+    pthread_mutex_unlock(&deque->lock);
+    return found;
+}
+
+static void *poolWorkerMain(void *arg){
+    poolWorker *worker = arg;
+    uint32_t taskIndex;
+
+    for (;;){
+        //Own work first, then look for a victim
+        int found = poolTake(&worker->deques[worker->self], 0, &taskIndex);
+        for (uint32_t offset = 1; !found && offset < worker->numThreads; offset++){
+            found = poolTake(&worker->deques[(worker->self + offset) % worker->numThreads], 1, &taskIndex);
+        }
+        if (!found){
+            return NULL;
+        }
+        worker->task(worker->args[taskIndex]);
+    }
+}
+
+//Number of online processors, at least one
+uint32_t poolDefaultThreads(void){
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    return cores > 0 ? (uint32_t) cores : 1;
+}
+
+//Runs task(args[i]) for every task and waits for all of them
+void poolRun(poolTask task, void **args, uint32_t numTasks, uint32_t numThreads){
+    if (numThreads > numTasks){
+        numThreads = numTasks;
+    }
+    if (numThreads == 0){
+        return;
+    }
+
+    poolDeque *deques = malloc(sizeof(poolDeque) * numThreads);
+    poolWorker *workers = malloc(sizeof(poolWorker) * numThreads);
+    pthread_t *threads = malloc(sizeof(pthread_t) * numThreads);
+
+    for (uint32_t t = 0; t < numThreads; t++){
+        pthread_mutex_init(&deques[t].lock, NULL);
+        deques[t].tasks = malloc(sizeof(uint32_t) * (numTasks / numThreads + 1));
+        deques[t].top = 0;
+        deques[t].bottom = 0;
+    }
+    for (uint32_t i = 0; i < numTasks; i++){
+        poolDeque *deque = &deques[i % numThreads];
+        deque->tasks[deque->bottom++] = i;
+    }
+
+    //The calling thread works as worker 0
+    for (uint32_t t = 0; t < numThreads; t++){
+        workers[t] = (poolWorker){ task, args, deques, numThreads, t };
+    }
+    for (uint32_t t = 1; t < numThreads; t++){
+        pthread_create(&threads[t], NULL, poolWorkerMain, &workers[t]);
+    }
+    poolWorkerMain(&workers[0]);
+    for (uint32_t t = 1; t < numThreads; t++){
+        pthread_join(threads[t], NULL);
+    }
+
+    for (uint32_t t = 0; t < numThreads; t++){
+        pthread_mutex_destroy(&deques[t].lock);
+        free(deques[t].tasks);
+    }
+    free(deques);
+    free(workers);
+    free(threads);
+}
+
+/////////////////////////////////////////////////////
+// End of file
+/////////////////////////////////////////////////////
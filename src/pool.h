@@ -0,0 +1,24 @@
+/////////////////////////////////////////////////////
+// CSC 252 Project 4
+// Cache Simulator
+// Wilfred Wallis and Chris Dalke
+/////////////////////////////////////////////////////
+// File: pool.h
+/////////////////////////////////////////////////////
+
+#ifndef POOL_H
+#define POOL_H
+
+#include <stdint.h>
+
+//A task receives the argument it was queued with
+typedef void (*poolTask)(void *arg);
+
+uint32_t poolDefaultThreads(void);
+void poolRun(poolTask task, void **args, uint32_t numTasks, uint32_t numThreads);
+
+#endif
+
+/////////////////////////////////////////////////////
+// End of file
+/////////////////////////////////////////////////////
@@ -0,0 +1,231 @@
+/////////////////////////////////////////////////////
+// CSC 252 Project 4
+// Cache Simulator
+// Wilfred Wallis and Chris Dalke
+/////////////////////////////////////////////////////
+// File: prefetch.c
+/////////////////////////////////////////////////////
+
+#include "cache.h"
+#include "prefetch.h"
+
+/////////////////////////////////////////////////////
+// Hardware prefetchers
+//
+// Next-line and stride prefetchers pick candidate blocks
+// after each demand access, and the model fills the ones
+// that are missing into the tag store, marked with
+// LINE_PREFETCHED. Stream buffers hold their blocks
+// outside the cache instead: a miss that finds its block
+// at the head of a buffer is served from there.
+//
+// The simulator has no notion of time, so every prefetch
+// arrives before it is needed: a useful prefetch is a
+// prefetched block that a demand access touches, and an
+// unused one is dropped before that happens. Pollution
+// is caught with a small filter of demand blocks that
+// prefetch fills evicted; a later demand miss on one of
+// them is a miss the prefetcher caused.
+/////////////////////////////////////////////////////
+
+static const char * const prefetchNames[NUM_PREFETCHERS] = {
+    "none", "nextline", "stride", "stream"
+};
+
+//Blocks ahead when no degree is given
+static const uint32_t defaultDegrees[NUM_PREFETCHERS] = { 0, 1, 2, 4 };
+
+//Returns the prefetcher with this name, or -1
+int prefetchParse(const char *name){
+    for (int kind = 0; kind < NUM_PREFETCHERS; kind++){
+        if (!strcmp(name, prefetchNames[kind])){
+            return kind;
+        }
+    }
+    return -1;
+}
+
+const char *prefetchName(uint32_t kind){
+    return kind < NUM_PREFETCHERS ? prefetchNames[kind] : "unknown";
+}
+
+//Sets up a prefetcher for a cache of numLines lines; degree 0 picks the default
+//Returns NULL for PREFETCH_NONE or a degree that is too large
+prefetcher *prefetchCreate(uint32_t kind, uint32_t degree, uint64_t numLines){
+    if (kind == PREFETCH_NONE || kind >= NUM_PREFETCHERS || degree > PREFETCH_MAX_DEGREE){
+        return NULL;
+    }
+    prefetcher *pf = calloc(1, sizeof(prefetcher));
+    pf->kind = kind;
+    pf->degree = degree ? degree : defaultDegrees[kind];
+
+    //One filter slot per cache line, rounded up to a power of two
+    uint64_t slots = 1;
+    while (slots < numLines){
+        slots <<= 1;
+    }
+    pf->pollutionFilter = calloc(slots, sizeof(addr_t));
+    pf->filterMask = slots - 1;
+    return pf;
+}
+
+static inline uint64_t prefetchHash(addr_t block){
+    return ((uint64_t)block * 0x9E3779B97F4A7C15ull) >> 17;
+}
+
+//Trains on a demand access and writes the blocks worth prefetching to 'blocks'
+//trigger: the access missed, or was the first use of a prefetched line
+//Returns how many blocks were written, at most the degree
+uint32_t prefetchCandidates(prefetcher *pf, addr_t address, uint32_t offsetBits, uint32_t trigger, addr_t *blocks){
+    addr_t block = address >> offsetBits;
+    uint32_t count = 0;
+
+    if (pf->kind == PREFETCH_NEXTLINE){
+        if (trigger){
+            for (uint32_t k = 1; k <= pf->degree; k++){
+                blocks[count++] = block + k;
+            }
+        }
+        return count;
+    }
+
+    if (pf->kind != PREFETCH_STRIDE){
+        return 0;
+    }
+
+    //Follow one stream per region
+    addr_t region = address >> STRIDE_REGION_BITS;
+    strideEntry *entry = &pf->strides[(region ^ (region >> 6)) & (STRIDE_TABLE_SIZE - 1)];
+    if (!entry->valid || entry->region != region){
+        entry->region = region;
+        entry->lastAddress = address;
+        entry->stride = 0;
+        entry->confidence = 0;
+        entry->valid = 1;
+        return 0;
+    }
+
+    int64_t stride = (int64_t)(uint64_t)address - (int64_t)(uint64_t)entry->lastAddress;
+    if (stride == 0){
+        return 0;
+    }
+    if (stride == entry->stride){
+        if (entry->confidence < STRIDE_CONFIDENT){
+            entry->confidence++;
+        }
+    } else {
+        entry->stride = stride;
+        entry->confidence = 0;
+    }
+    addr_t lastBlock = entry->lastAddress >> offsetBits;
+    entry->lastAddress = address;
+    if (entry->confidence < STRIDE_CONFIDENT){
+        return 0;
+    }
+
+    //Strides within a line only need a prefetch when a new line is entered,
+    //and then fetch whole lines ahead
+    int64_t lineSize = (int64_t)1 << offsetBits;
+    int64_t step = stride;
+    if (stride < lineSize && stride > -lineSize){
+        if (block == lastBlock){
+            return 0;
+        }
+        step = stride > 0 ? lineSize : -lineSize;
+    }
+    for (uint32_t k = 1; k <= pf->degree; k++){
+        blocks[count++] = (addr_t)((uint64_t)address + (uint64_t)(step * k)) >> offsetBits;
+    }
+    return count;
+}
+
+//Looks for a missing block at the head of the stream buffers
+//On a hit the block leaves the buffer, the buffer fetches one more, and 1 is returned
+uint32_t prefetchStreamTake(prefetcher *pf, addr_t block){
+    for (uint32_t b = 0; b < STREAM_BUFFERS; b++){
+        streamBuffer *buffer = &pf->streams[b];
+        if (buffer->count > 0 && buffer->blocks[buffer->head] == block){
+            buffer->blocks[buffer->head] = buffer->next++;
+            buffer->head = (buffer->head + 1) % pf->degree;
+            buffer->lastUse = ++pf->streamClock;
+            pf->useful++;
+            pf->issued++;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+//Starts a stream after a miss no buffer covered, replacing the least recently used buffer
+void prefetchStreamAllocate(prefetcher *pf, addr_t block){
+    streamBuffer *buffer = &pf->streams[0];
+    for (uint32_t b = 1; b < STREAM_BUFFERS; b++){
+        if (pf->streams[b].lastUse < buffer->lastUse){
+            buffer = &pf->streams[b];
+        }
+    }
+    pf->unused += buffer->count;
+
+    buffer->head = 0;
+    buffer->count = pf->degree;
+    for (uint32_t i = 0; i < pf->degree; i++){
+        buffer->blocks[i] = block + 1 + i;
+    }
+    buffer->next = block + 1 + pf->degree;
+    buffer->lastUse = ++pf->streamClock;
+    pf->issued += pf->degree;
+}
+
+//Remembers a demand block that a prefetch fill evicted
+void prefetchNoteVictim(prefetcher *pf, addr_t block){
+    pf->pollutionFilter[prefetchHash(block) & pf->filterMask] = block + 1;
+}
+
+//Counts a demand miss on a block a prefetch evicted
+void prefetchCheckPollution(prefetcher *pf, addr_t block){
+    addr_t *slot = &pf->pollutionFilter[prefetchHash(block) & pf->filterMask];
+    if (*slot == block + 1){
+        pf->pollutionMisses++;
+        *slot = 0;
+    }
+}
+
+//Saves the detector state, stream buffers, filter and counts; returns 0 on success
+int prefetchWrite(const prefetcher *pf, FILE *file){
+    uint64_t counts[5] = { pf->issued, pf->useful, pf->unused, pf->redundant, pf->pollutionMisses };
+    int failed = fwrite(pf->strides, sizeof(pf->strides), 1, file) != 1
+              || fwrite(pf->streams, sizeof(pf->streams), 1, file) != 1
+              || fwrite(&pf->streamClock, sizeof(pf->streamClock), 1, file) != 1
+              || fwrite(counts, sizeof(counts), 1, file) != 1
+              || fwrite(pf->pollutionFilter, sizeof(addr_t), pf->filterMask + 1, file) != pf->filterMask + 1;
+    return failed ? -1 : 0;
+}
+
+//Loads prefetchWrite's output into a prefetcher of the same kind and size
+int prefetchRead(prefetcher *pf, FILE *file){
+    uint64_t counts[5];
+    if (fread(pf->strides, sizeof(pf->strides), 1, file) != 1
+        || fread(pf->streams, sizeof(pf->streams), 1, file) != 1
+        || fread(&pf->streamClock, sizeof(pf->streamClock), 1, file) != 1
+        || fread(counts, sizeof(counts), 1, file) != 1
+        || fread(pf->pollutionFilter, sizeof(addr_t), pf->filterMask + 1, file) != pf->filterMask + 1){
+        return -1;
+    }
+    pf->issued = counts[0];
+    pf->useful = counts[1];
+    pf->unused = counts[2];
+    pf->redundant = counts[3];
+    pf->pollutionMisses = counts[4];
+    return 0;
+}
+
+void prefetchFree(prefetcher *pf){
+    if (pf != NULL){
+        free(pf->pollutionFilter);
+        free(pf);
+    }
+}
+
+/////////////////////////////////////////////////////
+// End of file
+/////////////////////////////////////////////////////
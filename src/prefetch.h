@@ -0,0 +1,89 @@
+/////////////////////////////////////////////////////
+// CSC 252 Project 4
+// Cache Simulator
+// Wilfred Wallis and Chris Dalke
+/////////////////////////////////////////////////////
+// File: prefetch.h
+/////////////////////////////////////////////////////
+
+#ifndef PREFETCH_H
+#define PREFETCH_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include "cache.h"
+
+//Prefetchers
+#define PREFETCH_NONE 0
+#define PREFETCH_NEXTLINE 1  //tagged next-line: on a miss or first use of a prefetched line
+#define PREFETCH_STRIDE 2    //per-region stride detection
+#define PREFETCH_STREAM 3    //Jouppi stream buffers beside the cache
+#define NUM_PREFETCHERS 4
+
+//Stride detector: direct-mapped table of 4KB regions
+#define STRIDE_TABLE_SIZE 64
+#define STRIDE_REGION_BITS 12
+#define STRIDE_CONFIDENT 2   //matching strides seen before prefetching
+
+//Stream buffers and the deepest one allowed
+#define STREAM_BUFFERS 4
+#define STREAM_MAX_DEPTH 16
+
+//Most blocks one access can prefetch
+#define PREFETCH_MAX_DEGREE 16
+
+typedef struct {
+    addr_t region;
+    addr_t lastAddress;
+    int64_t stride;
+    uint32_t confidence;
+    uint32_t valid;
+} strideEntry;
+
+//FIFO of blocks fetched ahead of a miss; only the head is checked
+typedef struct {
+    addr_t blocks[STREAM_MAX_DEPTH];
+    uint32_t head;
+    uint32_t count;
+    addr_t next;            //block to fetch when one is taken
+    uint64_t lastUse;       //for replacing the least recently used buffer
+} streamBuffer;
+
+//Prefetcher state and accounting for one cache
+typedef struct {
+    uint32_t kind;
+    uint32_t degree;        //blocks ahead, or stream buffer depth
+
+    strideEntry strides[STRIDE_TABLE_SIZE];
+    streamBuffer streams[STREAM_BUFFERS];
+    uint64_t streamClock;
+
+    //Demand blocks evicted by prefetch fills, hashed; 0 is empty, blocks are stored + 1
+    addr_t *pollutionFilter;
+    uint64_t filterMask;
+
+    //Accounting
+    uint64_t issued;            //blocks fetched from memory by prefetches
+    uint64_t useful;            //prefetched blocks later used by a demand access
+    uint64_t unused;            //prefetched blocks dropped before any use
+    uint64_t redundant;         //candidates already present, not fetched
+    uint64_t pollutionMisses;   //demand misses on blocks a prefetch evicted
+} prefetcher;
+
+int prefetchParse(const char *name);
+const char *prefetchName(uint32_t kind);
+prefetcher *prefetchCreate(uint32_t kind, uint32_t degree, uint64_t numLines);
+uint32_t prefetchCandidates(prefetcher *pf, addr_t address, uint32_t offsetBits, uint32_t trigger, addr_t *blocks);
+uint32_t prefetchStreamTake(prefetcher *pf, addr_t block);
+void prefetchStreamAllocate(prefetcher *pf, addr_t block);
+void prefetchNoteVictim(prefetcher *pf, addr_t block);
+void prefetchCheckPollution(prefetcher *pf, addr_t block);
+int prefetchWrite(const prefetcher *pf, FILE *file);
+int prefetchRead(prefetcher *pf, FILE *file);
+void prefetchFree(prefetcher *pf);
+
+#endif
+
+/////////////////////////////////////////////////////
+// End of file
+/////////////////////////////////////////////////////
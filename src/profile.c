@@ -0,0 +1,256 @@
+/////////////////////////////////////////////////////
+// CSC 252 Project 4
+// Cache Simulator
+// Wilfred Wallis and Chris Dalke
+/////////////////////////////////////////////////////
+// File: profile.c
+/////////////////////////////////////////////////////
+
+#include "cache.h"
+#include "trace.h"
+#include "model.h"
+#include "profile.h"
+
+/////////////////////////////////////////////////////
+// Detailed statistics export
+//
+// Per-set hit, miss, eviction and writeback counts are
+// kept by the model itself (modelTrackSets). Here we add
+// what needs the outcomes of a whole batch:
+// - miss rate over every interval of N accesses
+// - a histogram of LRU stack distances (distinct blocks
+//   touched between two uses of a block), bucketed by
+//   bit length like the sweep
+//
+// Exact stack distances cost a Fenwick tree update per
+// access, so only blocks whose hash falls in 1 of every
+// sampleRate hash values are followed. Distances among the
+// sampled blocks, scaled back up by the rate, estimate
+// distances among all of them (as in SHARDS), and the
+// other accesses pay for one hash.
+/////////////////////////////////////////////////////
+
+//Mixes a block number so sampling doesn't follow address patterns
+static inline uint64_t profileHash(addr_t block){
+    uint64_t z = (uint64_t)block * 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    return z ^ (z >> 31);
+}
+
+static profileEntry *profileFind(cacheProfile *profile, addr_t block){
+    uint64_t slot = (((uint64_t)block * 0x9E3779B97F4A7C15ull) >> 32) & profile->mask;
+    while (profile->entries[slot].lastTime != 0 && profile->entries[slot].block != block){
+        slot = (slot + 1) & profile->mask;
+    }
+    return &profile->entries[slot];
+}
+
+//Rehashes into a table twice the size
+static void profileGrow(cacheProfile *profile){
+    profileEntry *old = profile->entries;
+    uint64_t oldMask = profile->mask;
+    profile->mask = oldMask * 2 + 1;
+    profile->entries = calloc(profile->mask + 1, sizeof(profileEntry));
+    for (uint64_t slot = 0; slot <= oldMask; slot++){
+        if (old[slot].lastTime != 0){
+            *profileFind(profile, old[slot].block) = old[slot];
+        }
+    }
+    free(old);
+}
+
+//Bit length of a distance, used as its histogram bucket
+static inline uint32_t profileBucket(uint64_t distance){
+    uint32_t bucket = 0;
+    while (distance){
+        distance >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+//Records one access to a sampled block
+static void profileReuse(cacheProfile *profile, addr_t block){
+    uint64_t now = ++profile->sampledTime;
+    fenwickGrow(&profile->tree, now);
+
+    profileEntry *entry = profileFind(profile, block);
+    if (entry->lastTime == 0){
+        profile->coldSamples++;
+        entry->block = block;
+        profile->count++;
+    } else {
+        //Sampled blocks touched strictly in between, scaled to all blocks
+        uint64_t distance = fenwickPrefix(&profile->tree, now - 1) - fenwickPrefix(&profile->tree, entry->lastTime);
+        uint64_t scaled = distance * profile->sampleRate;
+        profile->reuseHist[profileBucket(scaled)]++;
+        fenwickAdd(&profile->tree, entry->lastTime, -1);
+    }
+    entry->lastTime = now;
+    fenwickAdd(&profile->tree, now, 1);
+
+    if (profile->count * 2 > profile->mask){
+        profileGrow(profile);
+    }
+}
+
+static void profileEndInterval(cacheProfile *profile){
+    if (profile->numIntervals == profile->intervalCapacity){
+        profile->intervalCapacity = profile->intervalCapacity ? profile->intervalCapacity * 2 : 64;
+        profile->intervals = realloc(profile->intervals, sizeof(profileInterval) * profile->intervalCapacity);
+    }
+    profile->intervals[profile->numIntervals++] = profile->current;
+    profile->current.accesses = 0;
+    profile->current.misses = 0;
+}
+
+/////////////////////////////////////////////////////
+// Profile functions
+// profileInit: starts profiling a model before its run
+// profileBatch: accounts for a simulated batch
+// profileWrite: exports everything as JSON, or CSV if
+//               the filename ends in ".csv"
+// profileFree: releases the profile
+/////////////////////////////////////////////////////
+
+int profileInit(cacheProfile *profile, cacheModel *model, uint32_t interval, uint32_t sampleRate){
+    memset(profile, 0, sizeof(*profile));
+    if (interval == 0 || sampleRate == 0 || modelTrackSets(model)){
+        return -1;
+    }
+    profile->model = model;
+    profile->interval = interval;
+    profile->sampleRate = sampleRate;
+    profile->sampleThreshold = sampleRate == 1 ? ~(uint64_t)0 : ~(uint64_t)0 / sampleRate;
+    profile->mask = 1023;
+    profile->entries = calloc(profile->mask + 1, sizeof(profileEntry));
+    fenwickInit(&profile->tree, 1024);
+    return 0;
+}
+
+void profileBatch(cacheProfile *profile, const traceRecord *records, const uint8_t *outcomes, uint32_t count){
+    uint32_t numOffsetBits = profile->model->numOffsetBits;
+    uint64_t sampleThreshold = profile->sampleThreshold;
+    for (uint32_t r = 0; r < count; r++){
+        profile->current.misses += outcomes[r] != HIT_SUCCESS;
+        if (++profile->current.accesses == profile->interval){
+            profileEndInterval(profile);
+        }
+
+        addr_t block = records[r].address >> numOffsetBits;
+        if (profileHash(block) <= sampleThreshold){
+            profileReuse(profile, block);
+        }
+    }
+}
+
+int profileWrite(cacheProfile *profile, const char *filename){
+    FILE *file = fopen(filename, "w");
+    if (file == NULL){
+        return -1;
+    }
+    size_t length = strlen(filename);
+    int csv = length >= 4 && !strcmp(filename + length - 4, ".csv");
+
+    //A trailing partial interval still counts
+    if (profile->current.accesses > 0){
+        profileEndInterval(profile);
+    }
+
+    const cacheModel *model = profile->model;
+    uint64_t evictions = 0;
+    uint64_t writebacks = 0;
+    for (uint32_t set = 0; set < model->numSets; set++){
+        evictions += model->setCounts[set].evictions;
+        writebacks += model->setCounts[set].writebacks;
+    }
+    double dirtyRatio = evictions ? (double) writebacks / evictions : 0.0;
+
+    //Long format for CSV: section,key,metric,value
+    if (csv){
+        fprintf(file, "section,key,metric,value\n");
+        fprintf(file, "total,all,accesses,%llu\n", (unsigned long long) model->numAccesses);
+        fprintf(file, "total,all,hits,%llu\n", (unsigned long long) model->totalHits);
+        fprintf(file, "total,all,misses,%llu\n", (unsigned long long) model->totalMisses);
+        fprintf(file, "total,all,evictions,%llu\n", (unsigned long long) evictions);
+        fprintf(file, "total,all,writebacks,%llu\n", (unsigned long long) writebacks);
+        fprintf(file, "total,all,dirty_eviction_ratio,%f\n", dirtyRatio);
+        for (uint32_t set = 0; set < model->numSets; set++){
+            const setCounters *counts = &model->setCounts[set];
+            fprintf(file, "set,%u,hits,%llu\nset,%u,misses,%llu\nset,%u,evictions,%llu\nset,%u,writebacks,%llu\n",
+                set, (unsigned long long) counts->hits, set, (unsigned long long) counts->misses,
+                set, (unsigned long long) counts->evictions, set, (unsigned long long) counts->writebacks);
+        }
+        fprintf(file, "reuse,cold,accesses,%llu\n", (unsigned long long) (profile->coldSamples * profile->sampleRate));
+        for (uint32_t bucket = 0; bucket < SWEEP_BUCKETS; bucket++){
+            if (profile->reuseHist[bucket]){
+                //Keyed by the shortest distance in the bucket
+                fprintf(file, "reuse,%llu,accesses,%llu\n", (unsigned long long) (bucket ? (uint64_t)1 << (bucket - 1) : 0),
+                    (unsigned long long) (profile->reuseHist[bucket] * profile->sampleRate));
+            }
+        }
+        for (uint32_t i = 0; i < profile->numIntervals; i++){
+            const profileInterval *interval = &profile->intervals[i];
+            fprintf(file, "interval,%u,accesses,%llu\ninterval,%u,misses,%llu\ninterval,%u,miss_rate,%f\n",
+                i, (unsigned long long) interval->accesses, i, (unsigned long long) interval->misses,
+                i, (double) interval->misses / interval->accesses);
+        }
+        fclose(file);
+        return 0;
+    }
+
+    fprintf(file, "{\n  \"config\": {\"size_kb\": %u, \"ways\": %u, \"line\": %u, \"policy\": \"%s\", \"sets\": %u},\n",
+        model->size, model->ways, model->line, modelPolicyName(model->replacementPolicy), model->numSets);
+    fprintf(file, "  \"totals\": {\"accesses\": %llu, \"hits\": %llu, \"misses\": %llu, \"evictions\": %llu, "
+        "\"writebacks\": %llu, \"dirty_eviction_ratio\": %f},\n",
+        (unsigned long long) model->numAccesses, (unsigned long long) model->totalHits,
+        (unsigned long long) model->totalMisses, (unsigned long long) evictions,
+        (unsigned long long) writebacks, dirtyRatio);
+
+    fprintf(file, "  \"sets\": [\n");
+    for (uint32_t set = 0; set < model->numSets; set++){
+        const setCounters *counts = &model->setCounts[set];
+        fprintf(file, "    {\"set\": %u, \"hits\": %llu, \"misses\": %llu, \"evictions\": %llu, \"writebacks\": %llu}%s\n",
+            set, (unsigned long long) counts->hits, (unsigned long long) counts->misses,
+            (unsigned long long) counts->evictions, (unsigned long long) counts->writebacks,
+            set + 1 < model->numSets ? "," : "");
+    }
+    fprintf(file, "  ],\n");
+
+    //Bucket b holds distances in [2^(b-1), 2^b - 1]; counts are scaled to all accesses
+    fprintf(file, "  \"reuse_distance\": {\"sample_rate\": %u, \"cold\": %llu, \"buckets\": [",
+        profile->sampleRate, (unsigned long long) (profile->coldSamples * profile->sampleRate));
+    uint32_t written = 0;
+    for (uint32_t bucket = 0; bucket < SWEEP_BUCKETS; bucket++){
+        if (profile->reuseHist[bucket]){
+            uint64_t low = bucket ? (uint64_t)1 << (bucket - 1) : 0;
+            uint64_t high = bucket >= 64 ? ~(uint64_t)0 : ((uint64_t)1 << bucket) - 1;
+            fprintf(file, "%s\n    {\"min\": %llu, \"max\": %llu, \"accesses\": %llu}", written++ ? "," : "",
+                (unsigned long long) low, (unsigned long long) high,
+                (unsigned long long) (profile->reuseHist[bucket] * profile->sampleRate));
+        }
+    }
+    fprintf(file, "%s]},\n", written ? "\n  " : "");
+
+    fprintf(file, "  \"intervals\": {\"length\": %u, \"points\": [", profile->interval);
+    for (uint32_t i = 0; i < profile->numIntervals; i++){
+        const profileInterval *interval = &profile->intervals[i];
+        fprintf(file, "%s\n    {\"accesses\": %llu, \"misses\": %llu, \"miss_rate\": %f}", i ? "," : "",
+            (unsigned long long) interval->accesses, (unsigned long long) interval->misses,
+            (double) interval->misses / interval->accesses);
+    }
+    fprintf(file, "%s]}\n}\n", profile->numIntervals ? "\n  " : "");
+
+    fclose(file);
+    return 0;
+}
+
+void profileFree(cacheProfile *profile){
+    free(profile->intervals);
+    free(profile->entries);
+    fenwickFree(&profile->tree);
+}
+
+/////////////////////////////////////////////////////
+// End of file
+/////////////////////////////////////////////////////
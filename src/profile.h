@@ -0,0 +1,64 @@
+/////////////////////////////////////////////////////
+// CSC 252 Project 4
+// Cache Simulator
+// Wilfred Wallis and Chris Dalke
+/////////////////////////////////////////////////////
+// File: profile.h
+/////////////////////////////////////////////////////
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stdint.h>
+#include "model.h"
+#include "sweep.h"
+
+//Defaults for -interval and -reuse-sample
+#define PROFILE_DEFAULT_INTERVAL 100000
+#define PROFILE_DEFAULT_SAMPLE 64
+
+//Accesses and misses in one interval of the run
+typedef struct {
+    uint64_t accesses;
+    uint64_t misses;
+} profileInterval;
+
+//Last sampled access to a block
+typedef struct {
+    addr_t block;
+    uint64_t lastTime;      //0 marks an empty slot
+} profileEntry;
+
+//Detailed statistics gathered alongside a model's run
+typedef struct {
+    cacheModel *model;
+
+    //Miss rate time series
+    uint32_t interval;
+    profileInterval *intervals;
+    uint32_t numIntervals;
+    uint32_t intervalCapacity;
+    profileInterval current;
+
+    //Reuse distances of the blocks picked by hash, 1 in sampleRate
+    uint32_t sampleRate;
+    uint64_t sampleThreshold;   //blocks hashing below this are followed
+    profileEntry *entries;
+    uint64_t mask;
+    uint64_t count;
+    fenwickTree tree;
+    uint64_t sampledTime;
+    uint64_t reuseHist[SWEEP_BUCKETS];
+    uint64_t coldSamples;
+} cacheProfile;
+
+int profileInit(cacheProfile *profile, cacheModel *model, uint32_t interval, uint32_t sampleRate);
+void profileBatch(cacheProfile *profile, const traceRecord *records, const uint8_t *outcomes, uint32_t count);
+int profileWrite(cacheProfile *profile, const char *filename);
+void profileFree(cacheProfile *profile);
+
+#endif
+
+/////////////////////////////////////////////////////
+// End of file
+/////////////////////////////////////////////////////
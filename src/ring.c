@@ -0,0 +1,98 @@
+/////////////////////////////////////////////////////
+// CSC 252 Project 4
+// Cache Simulator
+// Wilfred Wallis and Chris Dalke
+/////////////////////////////////////////////////////
+// File: ring.c
+/////////////////////////////////////////////////////
+
+#include <sched.h>
+#include "cache.h"
+#include "ring.h"
+
+/////////////////////////////////////////////////////
+// Lock-free SPSC ring
+//
+// The producer only writes tail and the consumer only
+// writes head, so neither needs a lock: a release store
+// of an index publishes the slot it covers, and the
+// acquire load on the other side sees it. The indices
+// count up forever and are masked on use, so full and
+// empty are tail - head == capacity and tail == head.
+/////////////////////////////////////////////////////
+
+//Spins before giving the CPU away while waiting
+#define RING_SPINS 256
+
+//Sets up an empty ring; capacity is rounded up to a power of two
+int ringInit(spscRing *ring, uint32_t capacity){
+    uint32_t size = 1;
+    while (size < capacity){
+        size <<= 1;
+    }
+    ring->slots = malloc(sizeof(void *) * size);
+    if (ring->slots == NULL){
+        return -1;
+    }
+    ring->mask = size - 1;
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+    return 0;
+}
+
+//Adds an item; returns 0 if it went in, 1 if the ring was full
+int ringTryPush(spscRing *ring, void *item){
+    uint64_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    uint64_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    if (tail - head > ring->mask){
+        return 1;
+    }
+    ring->slots[tail & ring->mask] = item;
+    atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+    return 0;
+}
+
+//Removes the oldest item; returns 0 if there was one, 1 if the ring was empty
+int ringTryPop(spscRing *ring, void **item){
+    uint64_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    uint64_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    if (head == tail){
+        return 1;
+    }
+    *item = ring->slots[head & ring->mask];
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+    return 0;
+}
+
+//Pushes, waiting for the consumer while the ring is full
+void ringPush(spscRing *ring, void *item){
+    uint32_t spins = 0;
+    while (ringTryPush(ring, item)){
+        if (++spins >= RING_SPINS){
+            sched_yield();
+            spins = 0;
+        }
+    }
+}
+
+//Pops, waiting for the producer while the ring is empty
+void *ringPop(spscRing *ring){
+    void *item;
+    uint32_t spins = 0;
+    while (ringTryPop(ring, &item)){
+        if (++spins >= RING_SPINS){
+            sched_yield();
+            spins = 0;
+        }
+    }
+    return item;
+}
+
+void ringFree(spscRing *ring){
+    free(ring->slots);
+    ring->slots = NULL;
+}
+
+/////////////////////////////////////////////////////
+// End of file
+/////////////////////////////////////////////////////
@@ -0,0 +1,38 @@
+/////////////////////////////////////////////////////
+// CSC 252 Project 4
+// Cache Simulator
+// Wilfred Wallis and Chris Dalke
+/////////////////////////////////////////////////////
+// File: ring.h
+/////////////////////////////////////////////////////
+
+#ifndef RING_H
+#define RING_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+
+//Host cache line, so the two indices never share one
+#define RING_ALIGN 64
+
+//Single-producer single-consumer queue of pointers.
+//Exactly one thread may push and exactly one may pop.
+typedef struct {
+    void **slots;
+    uint32_t mask; //capacity - 1, capacity is a power of two
+    _Alignas(RING_ALIGN) _Atomic uint64_t head; //next slot to pop, owned by the consumer
+    _Alignas(RING_ALIGN) _Atomic uint64_t tail; //next slot to push, owned by the producer
+} spscRing;
+
+int ringInit(spscRing *ring, uint32_t capacity);
+int ringTryPush(spscRing *ring, void *item);
+int ringTryPop(spscRing *ring, void **item);
+void ringPush(spscRing *ring, void *item);
+void *ringPop(spscRing *ring);
+void ringFree(spscRing *ring);
+
+#endif
+
+/////////////////////////////////////////////////////
+// End of file
+/////////////////////////////////////////////////////
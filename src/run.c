@@ -0,0 +1,320 @@
+/////////////////////////////////////////////////////
+// CSC 252 Project 4
+// Cache Simulator
+// Wilfred Wallis and Chris Dalke
+/////////////////////////////////////////////////////
+// File: run.c
+/////////////////////////////////////////////////////
+
+#include <time.h>
+#include "cache.h"
+#include "trace.h"
+#include "model.h"
+#include "pipeline.h"
+#include "profile.h"
+#include "checkpoint.h"
+#include "run.h"
+
+/////////////////////////////////////////////////////
+// simulateBatch function: Pipeline stage for the main cache
+/////////////////////////////////////////////////////
+
+//Rolling statistics printed while the trace is still coming in
+typedef struct {
+    uint64_t interval;          //accesses per report
+    uint64_t next;              //access count at which the next report is due
+    uint64_t accesses;          //totals at the previous report
+    uint64_t misses;
+    uint64_t compulsory;
+    uint64_t capacity;
+    uint64_t conflict;
+    double time;
+} liveReport;
+
+//The main cache and, with -export / -live, its detailed statistics
+typedef struct {
+    cacheModel *model;
+    cacheProfile *profile;
+    liveReport *live;
+    traceRun *runs;             //room for a batch of runs with -coalesce, or NULL
+} simulation;
+
+static double runNow(void){
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+//Starts the report windows from the model's current totals
+static void liveStart(liveReport *live, const cacheModel *model){
+    live->next = model->numAccesses + live->interval;
+    live->accesses = model->numAccesses;
+    live->misses = model->totalMisses;
+    live->compulsory = model->compulsoryMisses;
+    live->capacity = model->capacityMisses;
+    live->conflict = model->conflictMisses;
+    live->time = runNow();
+}
+
+//Prints the window since the previous report once an interval has gone by
+static void liveCheck(liveReport *live, const cacheModel *model){
+    if (model->numAccesses < live->next){
+        return;
+    }
+    double now = runNow();
+    uint64_t accesses = model->numAccesses - live->accesses;
+    uint64_t misses = model->totalMisses - live->misses;
+    double missShare = misses ? 100.0 / misses : 0.0;
+    fprintf(stderr, "[%llu-%llu] %.2fM accesses/s, miss rate %.4f%% (compulsory %.1f%%, capacity %.1f%%, conflict %.1f%%)\n",
+            (unsigned long long) live->accesses, (unsigned long long) model->numAccesses,
+            now > live->time ? accesses / (now - live->time) / 1e6 : 0.0,
+            accesses ? (double) misses / accesses * 100.0 : 0.0,
+            (model->compulsoryMisses - live->compulsory) * missShare,
+            (model->capacityMisses - live->capacity) * missShare,
+            (model->conflictMisses - live->conflict) * missShare);
+    liveStart(live, model);
+}
+
+static void simulateBatch(void *context, const traceRecord *records, uint32_t count, uint8_t *outcomes){
+    simulation *sim = context;
+    if (sim->runs != NULL){
+        uint32_t numRuns = traceCoalesce(records, count, sim->model->numOffsetBits, sim->runs);
+        modelAccessRuns(sim->model, records, sim->runs, numRuns, outcomes);
+    } else {
+        modelAccessBatch(sim->model, records, count, outcomes);
+    }
+    if (sim->profile != NULL){
+        profileBatch(sim->profile, records, outcomes, count);
+    }
+    if (sim->live != NULL){
+        liveCheck(sim->live, sim->model);
+    }
+}
+
+/////////////////////////////////////////////////////
+// runAdvance: simulates up to count more records in
+// this thread. Without a writer the outcomes are
+// dropped and only the cache state is kept, as for
+// fast-forwarding. Returns the records simulated
+/////////////////////////////////////////////////////
+
+static uint64_t runAdvance(simulation *sim, resultWriter *writer, uint64_t count){
+    //Records read from the trace, and what happened to each of them
+    traceRecord * batch = malloc( sizeof(traceRecord) * TRACE_BATCH_SIZE );
+    uint8_t * outcomes = malloc( sizeof(uint8_t) * TRACE_BATCH_SIZE );
+    uint64_t done = 0;
+    uint32_t numRead;
+
+    //Read in the file, a batch of records at a time
+    while (done < count && (numRead = traceReadBatch(batch, count - done < TRACE_BATCH_SIZE ? count - done : TRACE_BATCH_SIZE)) > 0){
+        if (writer != NULL){
+            //Simulate the accesses
+            simulateBatch(sim, batch, numRead, outcomes);
+
+            //Write the outcomes to the output file
+            outputWriteBatch(writer, batch, outcomes, numRead);
+        } else {
+            modelAccessBatch(sim->model, batch, numRead, outcomes);
+        }
+        done += numRead;
+    }
+    free(batch);
+    free(outcomes);
+    return done;
+}
+
+/////////////////////////////////////////////////////
+// runSingle: simulates one cache over a trace file,
+// writing per-access results next to the trace and
+// the statistics to stdout, as cacheSim always has
+/////////////////////////////////////////////////////
+
+int runSingle(char *filename, const runOptions *options){
+    /////////////////////////////////////////////////////
+    // Main Cache Initialization
+    /////////////////////////////////////////////////////
+
+    cacheModel model;
+    if (modelInit(&model, options->size, options->ways, options->line, options->replacementPolicy)){
+        printf("Could not set up a cache with these parameters\n");
+        return -1;
+    }
+    modelSeed(&model, options->seed);
+    if (modelSetPrefetcher(&model, options->prefetcher, options->prefetchDegree)){
+        printf("Could not set up the prefetcher\n");
+        return -1;
+    }
+    if (modelSetWritePolicy(&model, options->writePolicy, options->writeAllocate, options->writeBufferEntries)){
+        printf("Could not set up the write buffer\n");
+        return -1;
+    }
+    if (modelSetVictimCache(&model, options->victimEntries)){
+        printf("Could not set up the victim cache\n");
+        return -1;
+    }
+    if (modelSetWayPredictor(&model, options->wayPredictor)){
+        printf("Could not set up the way predictor\n");
+        return -1;
+    }
+
+    //Detailed statistics, if they are to be exported
+    cacheProfile profile;
+    simulation sim = { &model, NULL, NULL, NULL };
+    if (options->exportFilename != NULL){
+        if (profileInit(&profile, &model, options->exportInterval, options->reuseSample)){
+            printf("Could not set up statistics export\n");
+            return -1;
+        }
+        sim.profile = &profile;
+    }
+
+    //Runs of accesses to one block are simulated as a group when asked
+    if (options->coalesce){
+        sim.runs = malloc(sizeof(traceRun) * TRACE_BATCH_SIZE);
+    }
+
+    //Rolling reports, if asked for
+    liveReport live = { .interval = options->liveInterval };
+    if (options->liveInterval > 0){
+        sim.live = &live;
+    }
+
+    /////////////////////////////////////////////////////
+    // Program Output
+    /////////////////////////////////////////////////////
+
+    //Print out the parameters we grabbed for the cache
+    modelPrintHeader(&model, stdout);
+
+    /////////////////////////////////////////////////////
+    // Input File Initialization
+    /////////////////////////////////////////////////////
+
+    //Load the input file
+    if (traceOpen(filename)){
+        printf("Could not open trace file\n");
+        return -1;
+    }
+
+    /////////////////////////////////////////////////////
+    // Output File Initialization
+    // Result files will be stored in the trace folder
+    /////////////////////////////////////////////////////
+
+    //Name the filename based on the input file, adding the extension for the output mode
+    char * outputFilename = malloc( sizeof(char) * ( strlen(traceResultBase(filename)) + 16 ) );
+    strcpy(outputFilename,traceResultBase(filename));
+    strcat(outputFilename,outputExtension(options->outputMode));
+
+    //Open the output file stream
+    //We will write to this file later
+    resultWriter writer;
+    if (outputOpen(&writer, outputFilename, options->outputMode)){
+        printf("Could not open output file\n");
+        return -1;
+    }
+    free(outputFilename);
+
+    /////////////////////////////////////////////////////
+    // Checkpoints and Fast-Forward
+    /////////////////////////////////////////////////////
+
+    //Trace records consumed so far
+    uint64_t position = 0;
+
+    //Checkpoints name the trace they were taken on, so a restore can't skip the wrong records
+    uint64_t traceRecords = 0;
+    uint64_t traceChecksum = 0;
+    if ((options->restoreFilename != NULL || options->checkpointFilename != NULL) && traceIdentify(&traceRecords, &traceChecksum)){
+        traceRecords = CHECKPOINT_TRACE_UNKNOWN;
+    }
+
+    //Pick up the cache where an earlier run left it, and skip the records it covered
+    if (options->restoreFilename != NULL){
+        if (checkpointRestore(options->restoreFilename, &model, &position, traceRecords, traceChecksum)){
+            printf("Could not restore %s\n", options->restoreFilename);
+            return -1;
+        }
+        if (traceSkip(position) != position){
+            printf("The trace is shorter than checkpoint %s\n", options->restoreFilename);
+            return -1;
+        }
+        if (sim.profile != NULL){
+            fprintf(stderr, "Note: exported intervals and per-set counts cover only the accesses after the checkpoint\n");
+        }
+    }
+
+    //Warm the cache without output, then measure from a clean slate
+    if (options->fastForward > 0){
+        position += runAdvance(&sim, NULL, options->fastForward);
+        modelResetStats(&model);
+    }
+    if (sim.live != NULL){
+        liveStart(&live, &model);
+    }
+
+    //Run up to the checkpoint as usual, then save it
+    if (options->checkpointFilename != NULL){
+        if (options->checkpointAt < position){
+            printf("Checkpoint access %llu is already behind access %llu\n",
+                   (unsigned long long) options->checkpointAt, (unsigned long long) position);
+            return -1;
+        }
+        position += runAdvance(&sim, &writer, options->checkpointAt - position);
+        if (checkpointSave(options->checkpointFilename, &model, position, traceRecords, traceChecksum)){
+            printf("Could not write checkpoint %s\n", options->checkpointFilename);
+            return -1;
+        }
+        fprintf(stderr, "Checkpoint at access %llu written to %s\n", (unsigned long long) position, options->checkpointFilename);
+    }
+
+    /////////////////////////////////////////////////////
+    // Cache Simulation Loop
+    /////////////////////////////////////////////////////
+
+    //Overlap parsing and output with the simulation when it is worth a thread each
+    if (pipelineEnabled(options->pipelineMode)){
+        if (pipelineRun(simulateBatch, &sim, &writer)){
+            printf("Could not start the pipeline threads\n");
+            return -1;
+        }
+    } else {
+        runAdvance(&sim, &writer, UINT64_MAX);
+    }
+
+    /////////////////////////////////////////////////////
+    // End of Cache Simulation Loop
+    /////////////////////////////////////////////////////
+
+    /* Print results */
+    modelPrintStats(&model, stdout);
+    if (options->extraStats){
+        modelPrintExtraStats(&model, stdout);
+    }
+    if (sim.profile != NULL){
+        if (profileWrite(&profile, options->exportFilename)){
+            printf("Could not write %s\n", options->exportFilename);
+        }
+        profileFree(&profile);
+    }
+
+    /////////////////////////////////////////////////////
+    // Cleanup
+    /////////////////////////////////////////////////////
+
+    //Close the trace
+    traceClose();
+
+    //Close the output file
+    outputClose(&writer);
+
+    //Release the cache model
+    modelFree(&model);
+    free(sim.runs);
+
+    return 0;
+}
+
+/////////////////////////////////////////////////////
+// End of file
+/////////////////////////////////////////////////////
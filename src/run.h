@@ -0,0 +1,48 @@
+/////////////////////////////////////////////////////
+// CSC 252 Project 4
+// Cache Simulator
+// Wilfred Wallis and Chris Dalke
+/////////////////////////////////////////////////////
+// File: run.h
+/////////////////////////////////////////////////////
+
+#ifndef RUN_H
+#define RUN_H
+
+#include <stdint.h>
+
+//Settings for simulating one cache over a trace file
+typedef struct {
+    uint32_t size;              //total size (KB)
+    uint32_t ways;
+    uint32_t line;              //line size (B)
+    uint32_t replacementPolicy;
+    uint64_t seed;
+    uint32_t outputMode;        //OUTPUT_* for the per-access result file
+    uint32_t extraStats;        //print statistics beyond the GOLD format
+    uint32_t pipelineMode;      //PIPELINE_*
+    uint32_t prefetcher;        //PREFETCH_*
+    uint32_t prefetchDegree;    //0 for the prefetcher's default
+    uint32_t writePolicy;       //WRITE_BACK or WRITE_THROUGH
+    uint32_t writeAllocate;
+    uint32_t writeBufferEntries; //0 for no write buffer
+    uint32_t victimEntries;     //0 for no victim cache
+    uint32_t wayPredictor;      //WAYPRED_*
+    uint32_t coalesce;          //group back-to-back accesses to one block before simulating
+    char *exportFilename;       //detailed statistics file, or NULL
+    uint32_t exportInterval;
+    uint32_t reuseSample;
+    uint64_t fastForward;       //accesses simulated before statistics start
+    char *checkpointFilename;   //state saved after checkpointAt accesses, or NULL
+    uint64_t checkpointAt;
+    char *restoreFilename;      //checkpoint to resume from, or NULL
+    uint64_t liveInterval;      //accesses per rolling report on stderr, 0 for none
+} runOptions;
+
+int runSingle(char *filename, const runOptions *options);
+
+#endif
+
+/////////////////////////////////////////////////////
+// End of file
+/////////////////////////////////////////////////////
@@ -0,0 +1,173 @@
+/////////////////////////////////////////////////////
+// CSC 252 Project 4
+// Cache Simulator
+// Wilfred Wallis and Chris Dalke
+/////////////////////////////////////////////////////
+// File: sample.c
+/////////////////////////////////////////////////////
+
+#include "cache.h"
+#include "trace.h"
+#include "model.h"
+#include "sample.h"
+
+/////////////////////////////////////////////////////
+// Set sampling
+//
+// Sets never share blocks, so simulating a subset of
+// them gives exact results for those sets. About 1 in
+// 'ratio' sets is picked by a hash of the set index;
+// accesses to any other set are only counted.
+//
+// Every statistic is estimated as a ratio per access
+// over the sampled sets and scaled to the whole trace.
+// The sampled sets are a cluster sample, so the 95%
+// interval comes from the spread of the per-set
+// residuals y - R * accesses, with the finite
+// population correction for sampling without
+// replacement.
+//
+// The 3C split uses a shadow cache shrunk by the same
+// ratio, since it only sees the sampled sets' blocks.
+/////////////////////////////////////////////////////
+
+//Two-sided 95% normal quantile
+#define SAMPLE_Z95 1.959964
+
+static const char * const sampleLabels[SAMPLE_COUNTS] = {
+    "Accesses", "Misses", "Compulsory Misses", "Capacity Misses", "Conflict Misses",
+    "Read Transactions", "Write Transactions"
+};
+
+//Mixes a set index so the chosen sets don't follow a stride of the trace
+static inline uint32_t sampleHash(uint32_t index, uint64_t seed){
+    uint64_t x = index ^ seed;
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return (uint32_t)x;
+}
+
+//Ratio of one count to accesses over the sampled sets, and the 95% half-width of that ratio
+static void sampleEstimate(uint64_t (*counts)[SAMPLE_COUNTS], uint32_t numSampled, uint32_t numSets,
+                           uint32_t metric, double *ratio, double *halfWidth){
+    double sumY = 0.0;
+    double sumA = 0.0;
+    for (uint32_t s = 0; s < numSampled; s++){
+        sumY += counts[s][metric];
+        sumA += counts[s][SAMPLE_ACCESSES];
+    }
+    *ratio = sumY / sumA;
+
+    double residuals = 0.0;
+    for (uint32_t s = 0; s < numSampled; s++){
+        double residual = counts[s][metric] - *ratio * counts[s][SAMPLE_ACCESSES];
+        residuals += residual * residual;
+    }
+    double meanA = sumA / numSampled;
+    double fraction = (double) numSampled / numSets;
+    double variance = (1.0 - fraction) * residuals / (numSampled - 1) / (numSampled * meanA * meanA);
+    *halfWidth = SAMPLE_Z95 * sqrt(variance);
+}
+
+/////////////////////////////////////////////////////
+// runSample: simulates 1 in 'ratio' sets of one cache
+// and prints estimates with 95% confidence intervals
+/////////////////////////////////////////////////////
+
+int runSample(char *filename, uint32_t size, uint32_t ways, uint32_t line, uint32_t replacementPolicy, uint64_t seed, uint32_t ratio){
+    cacheModel model;
+    if (modelInit(&model, size, ways, line, replacementPolicy)){
+        printf("Could not set up a cache with these parameters\n");
+        return -1;
+    }
+    modelSeed(&model, seed);
+
+    //Pick the sets; an interval needs at least two
+    uint32_t numSets = model.numSets;
+    uint32_t *slots = malloc(sizeof(uint32_t) * numSets);
+    uint32_t numSampled = 0;
+    for (uint32_t set = 0; set < numSets; set++){
+        slots[set] = sampleHash(set, seed) % ratio == 0 ? numSampled++ : SAMPLE_NONE;
+    }
+    if (numSampled < 2 || modelScaleShadow(&model, ratio)){
+        printf("Too few sets to sample 1 in %u\n", ratio);
+        free(slots);
+        modelFree(&model);
+        return -1;
+    }
+
+    if (traceOpen(filename)){
+        printf("Could not open trace file\n");
+        free(slots);
+        modelFree(&model);
+        return -1;
+    }
+
+    uint64_t (*counts)[SAMPLE_COUNTS] = calloc(numSampled, sizeof(*counts));
+    uint64_t totalAccesses = 0;
+    uint32_t numOffsetBits = model.numOffsetBits;
+    addr_t indexMask = numSets - 1;
+
+    traceRecord *batch = malloc(sizeof(traceRecord) * TRACE_BATCH_SIZE);
+    uint32_t numRead;
+    while ((numRead = traceReadBatch(batch, TRACE_BATCH_SIZE)) > 0){
+        totalAccesses += numRead;
+        for (uint32_t r = 0; r < numRead; r++){
+            //Unsampled sets do no tag-store or shadow work at all
+            uint32_t slot = slots[(batch[r].address >> numOffsetBits) & indexMask];
+            if (slot == SAMPLE_NONE){
+                continue;
+            }
+
+            uint64_t reads = model.readXactions;
+            uint64_t writes = model.writeXactions;
+            uint32_t outcome = modelAccess(&model, batch[r].address, batch[r].isStore);
+
+            uint64_t *setCounts = counts[slot];
+            setCounts[SAMPLE_ACCESSES]++;
+            if (outcome != HIT_SUCCESS){
+                setCounts[SAMPLE_MISSES]++;
+                setCounts[outcome == COMPULSORY_MISS ? SAMPLE_COMPULSORY
+                        : outcome == CAPACITY_MISS ? SAMPLE_CAPACITY : SAMPLE_CONFLICT]++;
+            }
+            setCounts[SAMPLE_READS] += model.readXactions - reads;
+            setCounts[SAMPLE_WRITES] += model.writeXactions - writes;
+        }
+    }
+    free(batch);
+    traceClose();
+
+    /////////////////////////////////////////////////////
+    // Report
+    /////////////////////////////////////////////////////
+
+    modelPrintHeader(&model, stdout);
+    printf("Sampled %u of %u sets (1 in %u): %llu of %llu accesses simulated\n", numSampled, numSets, ratio,
+           (unsigned long long) model.numAccesses, (unsigned long long) totalAccesses);
+
+    if (model.numAccesses == 0){
+        printf("No accesses fell in the sampled sets\n");
+    } else {
+        double ratioEstimate, halfWidth;
+        sampleEstimate(counts, numSampled, numSets, SAMPLE_MISSES, &ratioEstimate, &halfWidth);
+        printf("Miss Rate: %8lf%% +/- %lf%% (95%% confidence)\n", ratioEstimate * 100.0, halfWidth * 100.0);
+
+        //Totals scale the per-access ratio to the whole trace
+        for (uint32_t metric = SAMPLE_MISSES; metric < SAMPLE_COUNTS; metric++){
+            sampleEstimate(counts, numSampled, numSets, metric, &ratioEstimate, &halfWidth);
+            printf("%s: %.0lf +/- %.0lf\n", sampleLabels[metric], ratioEstimate * totalAccesses, halfWidth * totalAccesses);
+        }
+    }
+
+    free(counts);
+    free(slots);
+    modelFree(&model);
+    return 0;
+}
+
+/////////////////////////////////////////////////////
+// End of file
+/////////////////////////////////////////////////////
@@ -0,0 +1,33 @@
+/////////////////////////////////////////////////////
+// CSC 252 Project 4
+// Cache Simulator
+// Wilfred Wallis and Chris Dalke
+/////////////////////////////////////////////////////
+// File: sample.h
+/////////////////////////////////////////////////////
+
+#ifndef SAMPLE_H
+#define SAMPLE_H
+
+#include <stdint.h>
+
+//Marks a set that is not simulated
+#define SAMPLE_NONE 0xFFFFFFFF
+
+//Counts kept for every sampled set
+#define SAMPLE_ACCESSES 0
+#define SAMPLE_MISSES 1
+#define SAMPLE_COMPULSORY 2
+#define SAMPLE_CAPACITY 3
+#define SAMPLE_CONFLICT 4
+#define SAMPLE_READS 5
+#define SAMPLE_WRITES 6
+#define SAMPLE_COUNTS 7
+
+int runSample(char *filename, uint32_t size, uint32_t ways, uint32_t line, uint32_t replacementPolicy, uint64_t seed, uint32_t ratio);
+
+#endif
+
+/////////////////////////////////////////////////////
+// End of file
+/////////////////////////////////////////////////////
@@ -0,0 +1,163 @@
+/////////////////////////////////////////////////////
+// CSC 252 Project 4
+// Cache Simulator
+// Wilfred Wallis and Chris Dalke
+/////////////////////////////////////////////////////
+// File: shadow.c
+/////////////////////////////////////////////////////
+
+#include "cache.h"
+#include "shadow.h"
+
+/////////////////////////////////////////////////////
+// Shadow fully-associative cache
+//
+// The 3C classification needs to know whether a fully
+// associative cache of the same size would have hit.
+// Instead of scanning every way on each access, blocks
+// are found through a chained hash table and kept in a
+// doubly linked list ordered by insertion (FIFO) or by
+// last use (LRU). Lookup, promotion and eviction are all
+// constant time.
+//
+// The list order matches the lowest-age scan the old
+// arrays used: empty ways are filled first, then the
+// tail (oldest age) is evicted.
+/////////////////////////////////////////////////////
+
+//Multiplicative hash of a block number
+static inline uint32_t shadowHash(const shadowCache *sc, addr_t block){
+    return (uint32_t)(((uint64_t)block * 0x9E3779B97F4A7C15ull) >> sc->hashShift);
+}
+
+//Detaches a node from the recency list
+static inline void shadowUnlink(shadowCache *sc, uint32_t node){
+    shadowNode *n = &sc->nodes[node];
+    if (n->prev != SHADOW_NONE){
+        sc->nodes[n->prev].next = n->next;
+    } else {
+        sc->head = n->next;
+    }
+    if (n->next != SHADOW_NONE){
+        sc->nodes[n->next].prev = n->prev;
+    } else {
+        sc->tail = n->prev;
+    }
+}
+
+//Puts a node at the most recent end of the list
+static inline void shadowPushFront(shadowCache *sc, uint32_t node){
+    shadowNode *n = &sc->nodes[node];
+    n->prev = SHADOW_NONE;
+    n->next = sc->head;
+    if (sc->head != SHADOW_NONE){
+        sc->nodes[sc->head].prev = node;
+    } else {
+        sc->tail = node;
+    }
+    sc->head = node;
+}
+
+//Removes a node from its hash chain
+static void shadowUnhash(shadowCache *sc, uint32_t node){
+    uint32_t *link = &sc->buckets[shadowHash(sc, sc->nodes[node].block)];
+    while (*link != node){
+        link = &sc->nodes[*link].hashNext;
+    }
+    *link = sc->nodes[node].hashNext;
+}
+
+int shadowInit(shadowCache *sc, uint32_t numWays, uint32_t policy){
+    //Use at least twice as many buckets as ways to keep chains short
+    uint32_t bucketBits = 1;
+    while (((uint64_t)1 << bucketBits) < (uint64_t)numWays * 2){
+        bucketBits++;
+    }
+
+    sc->numWays = numWays;
+    sc->numUsed = 0;
+    sc->policy = policy;
+    sc->hashShift = 64 - bucketBits;
+    sc->buckets = malloc(sizeof(uint32_t) * ((size_t)1 << bucketBits));
+    sc->nodes = malloc(sizeof(shadowNode) * numWays);
+    sc->head = SHADOW_NONE;
+    sc->tail = SHADOW_NONE;
+
+    if (sc->buckets == NULL || sc->nodes == NULL){
+        shadowFree(sc);
+        return -1;
+    }
+
+    memset(sc->buckets, 0xFF, sizeof(uint32_t) * ((size_t)1 << bucketBits));
+    return 0;
+}
+
+//Looks up a block and updates the shadow cache
+//Returns HIT_SUCCESS on a hit, UNKNOWN_MISS otherwise
+uint32_t shadowAccess(shadowCache *sc, addr_t block){
+    uint32_t bucket = shadowHash(sc, block);
+
+    //Walk the hash chain looking for the block
+    for (uint32_t node = sc->buckets[bucket]; node != SHADOW_NONE; node = sc->nodes[node].hashNext){
+        if (sc->nodes[node].block == block){
+            //LRU moves the block to the front on every use, FIFO leaves it alone
+            if (sc->policy == LRU && sc->head != node){
+                shadowUnlink(sc, node);
+                shadowPushFront(sc, node);
+            }
+            return HIT_SUCCESS;
+        }
+    }
+
+    //Miss: take an unused node if there is one, else evict the tail
+    uint32_t node;
+    if (sc->numUsed < sc->numWays){
+        node = sc->numUsed++;
+    } else {
+        node = sc->tail;
+        shadowUnlink(sc, node);
+        shadowUnhash(sc, node);
+    }
+
+    sc->nodes[node].block = block;
+    sc->nodes[node].hashNext = sc->buckets[bucket];
+    sc->buckets[bucket] = node;
+    shadowPushFront(sc, node);
+
+    return UNKNOWN_MISS;
+}
+
+//Saves the blocks held, oldest first; returns 0 on success
+int shadowWrite(const shadowCache *sc, FILE *file){
+    int failed = fwrite(&sc->numUsed, sizeof(sc->numUsed), 1, file) != 1;
+    for (uint32_t node = sc->tail; node != SHADOW_NONE && !failed; node = sc->nodes[node].prev){
+        failed = fwrite(&sc->nodes[node].block, sizeof(addr_t), 1, file) != 1;
+    }
+    return failed ? -1 : 0;
+}
+
+//Refills an empty shadow cache of the same size from shadowWrite's output.
+//Replaying the blocks oldest first rebuilds the same recency order.
+int shadowRead(shadowCache *sc, FILE *file){
+    uint32_t numUsed;
+    if (fread(&numUsed, sizeof(numUsed), 1, file) != 1 || numUsed > sc->numWays){
+        return -1;
+    }
+    for (uint32_t i = 0; i < numUsed; i++){
+        addr_t block;
+        if (fread(&block, sizeof(block), 1, file) != 1){
+            return -1;
+        }
+        shadowAccess(sc, block);
+    }
+    return 0;
+}
+
+void shadowFree(shadowCache *sc){
+    free(sc->buckets);
+    free(sc->nodes);
+}
+
+/////////////////////////////////////////////////////
+// End of file
+/////////////////////////////////////////////////////
@@ -0,0 +1,50 @@
+/////////////////////////////////////////////////////
+// CSC 252 Project 4
+// Cache Simulator
+// Wilfred Wallis and Chris Dalke
+/////////////////////////////////////////////////////
+// File: shadow.h
+/////////////////////////////////////////////////////
+
+#ifndef SHADOW_H
+#define SHADOW_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include "cache.h"
+
+//Marks an empty bucket / end of a list
+#define SHADOW_NONE 0xFFFFFFFF
+
+//One block held by the shadow cache
+//Each node sits in a hash chain and in the recency list at once
+typedef struct {
+    addr_t block;      //block number (address without offset bits)
+    uint32_t hashNext; //next node in the same hash bucket
+    uint32_t prev;     //neighbour towards the most recent end
+    uint32_t next;     //neighbour towards the eviction end
+} shadowNode;
+
+//Fully-associative shadow cache used for 3C miss classification
+typedef struct {
+    uint32_t numWays;    //capacity in blocks
+    uint32_t numUsed;    //number of nodes handed out so far
+    uint32_t policy;     //FIFO or LRU
+    uint32_t hashShift;  //shift that turns the hash into a bucket index
+    uint32_t *buckets;   //first node index in each bucket
+    shadowNode *nodes;
+    uint32_t head;       //most recently inserted / used
+    uint32_t tail;       //next to be evicted
+} shadowCache;
+
+int shadowInit(shadowCache *sc, uint32_t numWays, uint32_t policy);
+uint32_t shadowAccess(shadowCache *sc, addr_t block);
+int shadowWrite(const shadowCache *sc, FILE *file);
+int shadowRead(shadowCache *sc, FILE *file);
+void shadowFree(shadowCache *sc);
+
+#endif
+
+/////////////////////////////////////////////////////
+// End of file
+/////////////////////////////////////////////////////
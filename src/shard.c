@@ -0,0 +1,167 @@
+/////////////////////////////////////////////////////
+// CSC 252 Project 4
+// Cache Simulator
+// Wilfred Wallis and Chris Dalke
+/////////////////////////////////////////////////////
+// File: shard.c
+/////////////////////////////////////////////////////
+
+#include "cache.h"
+#include "trace.h"
+#include "model.h"
+#include "pool.h"
+#include "shard.h"
+
+/////////////////////////////////////////////////////
+// Set-sharded simulation of one configuration
+//
+// The trace is parsed into memory once. Each shard task
+// simulates its interleaved share of the sets over the
+// whole trace, writing outcome codes in place, while one
+// more task runs the fully-associative shadow cache over
+// every access in order. Afterwards the shadow results
+// turn each shard's undecided misses into conflict or
+// capacity misses, so the 3C split is exactly that of a
+// sequential run, and the outcomes are already in trace
+// order for the result file.
+/////////////////////////////////////////////////////
+
+typedef struct {
+    cacheModel *model;        //a shard, or the owner for the shadow task
+    uint32_t isShadow;
+    const traceRecord *records;
+    uint64_t numRecords;
+    uint8_t *outcomes;        //shards: outcome codes
+    uint8_t *shadowHits;      //shadow task: 1 where the shadow cache hit
+} shardJob;
+
+static void shardRunJob(void *arg){
+    shardJob *job = arg;
+    if (!job->isShadow){
+        modelAccessShard(job->model, job->records, job->numRecords, job->outcomes);
+        return;
+    }
+
+    cacheModel *model = job->model;
+    for (uint64_t r = 0; r < job->numRecords; r++){
+        addr_t block = extractBitSequence(job->records[r].address, model->numOffsetBits, ADDR_BITS - model->numOffsetBits);
+        job->shadowHits[r] = shadowAccess(&model->fullyAssocCache, block) == HIT_SUCCESS;
+    }
+}
+
+/////////////////////////////////////////////////////
+// runSharded: one configuration on numThreads threads
+/////////////////////////////////////////////////////
+
+int runSharded(char *filename, uint32_t size, uint32_t ways, uint32_t line, uint32_t replacementPolicy,
+               uint32_t numThreads, uint32_t outputMode, uint32_t extraStats){
+    cacheModel model;
+    if (modelInit(&model, size, ways, line, replacementPolicy)){
+        printf("Could not set up a cache with these parameters\n");
+        return -1;
+    }
+    modelPrintHeader(&model, stdout);
+
+    uint64_t numRecords;
+    traceRecord *records = traceLoad(filename, &numRecords);
+    if (records == NULL){
+        printf("Could not open trace file\n");
+        modelFree(&model);
+        return -1;
+    }
+
+    char *outputFilename = malloc(strlen(traceResultBase(filename)) + 16);
+    strcpy(outputFilename, traceResultBase(filename));
+    strcat(outputFilename, outputExtension(outputMode));
+    resultWriter writer;
+    if (outputOpen(&writer, outputFilename, outputMode)){
+        printf("Could not open output file\n");
+        free(outputFilename);
+        free(records);
+        modelFree(&model);
+        return -1;
+    }
+    free(outputFilename);
+
+    //The shadow task takes one thread; the sets are split over the rest
+    uint32_t numShards = numThreads > 1 ? numThreads - 1 : 1;
+    if (numShards > model.numSets){
+        numShards = model.numSets;
+    }
+    cacheModel *shards = malloc(sizeof(cacheModel) * numShards);
+    shardJob *jobs = calloc(numShards + 1, sizeof(shardJob));
+    void **args = malloc(sizeof(void *) * (numShards + 1));
+    uint8_t *outcomes = malloc(numRecords ? numRecords : 1);
+    uint8_t *shadowHits = malloc(numRecords ? numRecords : 1);
+
+    for (uint32_t s = 0; s <= numShards; s++){
+        jobs[s].records = records;
+        jobs[s].numRecords = numRecords;
+        if (s < numShards){
+            modelShardInit(&shards[s], &model, s, numShards);
+            jobs[s].model = &shards[s];
+            jobs[s].outcomes = outcomes;
+        } else {
+            jobs[s].model = &model;
+            jobs[s].isShadow = 1;
+            jobs[s].shadowHits = shadowHits;
+        }
+        args[s] = &jobs[s];
+    }
+
+    poolRun(shardRunJob, args, numShards + 1, numThreads);
+
+    //Merge the shards' counters into the owner
+    for (uint32_t s = 0; s < numShards; s++){
+        model.numAccesses += shards[s].numAccesses;
+        model.totalHits += shards[s].totalHits;
+        model.totalMisses += shards[s].totalMisses;
+        model.readXactions += shards[s].readXactions;
+        model.writeXactions += shards[s].writeXactions;
+        model.storeFills += shards[s].storeFills;
+        model.writebacks += shards[s].writebacks;
+        model.storeWrites += shards[s].storeWrites;
+        model.writeBytes += shards[s].writeBytes;
+        model.compulsoryMisses += shards[s].compulsoryMisses;
+        model.installs += shards[s].installs;
+        model.invalidations += shards[s].invalidations;
+        model.touchedBlocks.numBlocks += shards[s].touchedBlocks.numBlocks;
+        modelShardFree(&shards[s]);
+    }
+
+    //Settle conflict vs capacity, then write the outcomes in trace order
+    for (uint64_t start = 0; start < numRecords; start += TRACE_BATCH_SIZE){
+        uint32_t count = numRecords - start < TRACE_BATCH_SIZE ? numRecords - start : TRACE_BATCH_SIZE;
+        for (uint64_t r = start; r < start + count; r++){
+            if (outcomes[r] == UNKNOWN_MISS){
+                if (shadowHits[r]){
+                    outcomes[r] = CONFLICT_MISS;
+                    model.conflictMisses++;
+                } else {
+                    outcomes[r] = CAPACITY_MISS;
+                    model.capacityMisses++;
+                }
+            }
+        }
+        outputWriteBatch(&writer, records + start, outcomes + start, count);
+    }
+
+    modelPrintStats(&model, stdout);
+    if (extraStats){
+        modelPrintExtraStats(&model, stdout);
+    }
+
+    outputClose(&writer);
+    free(outcomes);
+    free(shadowHits);
+    free(args);
+    free(jobs);
+    free(shards);
+    free(records);
+    modelFree(&model);
+    return 0;
+}
+
+/////////////////////////////////////////////////////
+// End of file
+/////////////////////////////////////////////////////
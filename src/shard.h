@@ -0,0 +1,21 @@
+/////////////////////////////////////////////////////
+// CSC 252 Project 4
+// Cache Simulator
+// Wilfred Wallis and Chris Dalke
+/////////////////////////////////////////////////////
+// File: shard.h
+/////////////////////////////////////////////////////
+
+#ifndef SHARD_H
+#define SHARD_H
+
+#include <stdint.h>
+
+int runSharded(char *filename, uint32_t size, uint32_t ways, uint32_t line, uint32_t replacementPolicy,
+               uint32_t numThreads, uint32_t outputMode, uint32_t extraStats);
+
+#endif
+
+/////////////////////////////////////////////////////
+// End of file
+/////////////////////////////////////////////////////
@@ -0,0 +1,196 @@
+/////////////////////////////////////////////////////
+// CSC 252 Project 4
+// Cache Simulator
+// Wilfred Wallis and Chris Dalke
+/////////////////////////////////////////////////////
+// File: shmring.c
+/////////////////////////////////////////////////////
+
+#include <sched.h>
+#include <time.h>
+#include "cache.h"
+#include "shmring.h"
+
+/////////////////////////////////////////////////////
+// Shared-memory trace ring
+//
+// Lets an instrumented program hand accesses straight
+// to cacheSim without a trace file. cacheSim creates
+// a POSIX shared-memory segment ("-t shm:/name"), the
+// producer connects to it and writes records, and
+// closes it to mark the end of the trace. Indices work
+// as in ring.c: each side writes only its own, with
+// release stores that publish the records they cover.
+/////////////////////////////////////////////////////
+
+//Spins before giving the CPU away while waiting
+#define SHMRING_SPINS 256
+
+//Maps a segment of the given size; returns NULL on failure
+static shmRing *shmRingMap(int fd, size_t mapSize){
+    void *map = mmap(NULL, mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED){
+        return NULL;
+    }
+    shmRing *ring = calloc(1, sizeof(shmRing));
+    ring->header = map;
+    ring->records = (shmRecord *)((char *)map + sizeof(shmRingHeader));
+    ring->mapSize = mapSize;
+    return ring;
+}
+
+//Unmaps without touching the shared state
+static void shmRingUnmap(shmRing *ring){
+    munmap(ring->header, ring->mapSize);
+    free(ring);
+}
+
+//Waits a little, spinning at first and then yielding
+static inline void shmRingWait(uint32_t *spins){
+    if (++*spins >= SHMRING_SPINS){
+        sched_yield();
+        *spins = 0;
+    }
+}
+
+//Creates the consumer end; capacity is rounded up to a power of two.
+//A stale segment of the same name is replaced
+shmRing *shmRingCreate(const char *name, uint32_t capacity){
+    uint32_t size = 1;
+    while (size < capacity){
+        size <<= 1;
+    }
+    size_t mapSize = sizeof(shmRingHeader) + (size_t)size * sizeof(shmRecord);
+
+    shm_unlink(name);
+    int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0){
+        return NULL;
+    }
+    if (ftruncate(fd, mapSize)){
+        close(fd);
+        shm_unlink(name);
+        return NULL;
+    }
+    shmRing *ring = shmRingMap(fd, mapSize);
+    if (ring == NULL){
+        shm_unlink(name);
+        return NULL;
+    }
+    ring->name = strdup(name);
+
+    //The segment starts zeroed, so only the description needs filling in
+    shmRingHeader *header = ring->header;
+    memcpy(header->magic, SHMRING_MAGIC, sizeof(header->magic));
+    header->version = SHMRING_VERSION;
+    header->capacity = size;
+    atomic_store_explicit(&header->ready, 1, memory_order_release);
+    return ring;
+}
+
+//Opens the producer end, waiting for cacheSim to create the segment
+shmRing *shmRingConnect(const char *name){
+    struct timespec pause = { 0, 10 * 1000000 };
+    for (uint32_t waited = 0; waited < SHMRING_CONNECT_TIMEOUT; waited += 10){
+        int fd = shm_open(name, O_RDWR, 0);
+        struct stat info;
+        if (fd >= 0 && fstat(fd, &info) == 0 && (size_t)info.st_size > sizeof(shmRingHeader)){
+            shmRing *ring = shmRingMap(fd, info.st_size);
+            if (ring == NULL){
+                return NULL;
+            }
+            shmRingHeader *header = ring->header;
+            if (atomic_load_explicit(&header->ready, memory_order_acquire)){
+                if (memcmp(header->magic, SHMRING_MAGIC, sizeof(header->magic)) || header->version != SHMRING_VERSION
+                    || sizeof(shmRingHeader) + (size_t)header->capacity * sizeof(shmRecord) > ring->mapSize){
+                    shmRingUnmap(ring);
+                    return NULL;
+                }
+                return ring;
+            }
+            shmRingUnmap(ring);
+        } else if (fd >= 0){
+            close(fd);
+        }
+        nanosleep(&pause, NULL);
+    }
+    return NULL;
+}
+
+//Appends records, waiting for the consumer while the ring is full
+void shmRingWrite(shmRing *ring, const traceRecord *records, uint32_t count){
+    shmRingHeader *header = ring->header;
+    uint64_t mask = header->capacity - 1;
+    uint64_t tail = atomic_load_explicit(&header->tail, memory_order_relaxed);
+    uint32_t written = 0;
+    uint32_t spins = 0;
+
+    while (written < count){
+        uint64_t head = atomic_load_explicit(&header->head, memory_order_acquire);
+        uint64_t space = header->capacity - (tail - head);
+        if (space == 0){
+            shmRingWait(&spins);
+            continue;
+        }
+        uint32_t chunk = count - written < space ? count - written : (uint32_t)space;
+        for (uint32_t r = 0; r < chunk; r++){
+            shmRecord *slot = &ring->records[(tail + r) & mask];
+            slot->address = records[written + r].address;
+            slot->isStore = records[written + r].isStore;
+            slot->core = records[written + r].core;
+        }
+        tail += chunk;
+        written += chunk;
+        atomic_store_explicit(&header->tail, tail, memory_order_release);
+    }
+}
+
+//Takes up to maxRecords, waiting while the ring is empty.
+//Returns 0 only once the producer has closed its end and everything is read
+uint32_t shmRingRead(shmRing *ring, traceRecord *records, uint32_t maxRecords){
+    shmRingHeader *header = ring->header;
+    uint64_t mask = header->capacity - 1;
+    uint64_t head = atomic_load_explicit(&header->head, memory_order_relaxed);
+    uint32_t spins = 0;
+
+    for (;;){
+        //Check for the end first, so records written just before it are not missed
+        uint32_t closed = atomic_load_explicit(&header->closed, memory_order_acquire);
+        uint64_t tail = atomic_load_explicit(&header->tail, memory_order_acquire);
+        if (tail != head){
+            uint32_t count = tail - head < maxRecords ? (uint32_t)(tail - head) : maxRecords;
+            for (uint32_t r = 0; r < count; r++){
+                const shmRecord *slot = &ring->records[(head + r) & mask];
+                records[r].address = (addr_t)slot->address;
+                records[r].isStore = slot->isStore;
+                records[r].core = slot->core;
+            }
+            atomic_store_explicit(&header->head, head + count, memory_order_release);
+            return count;
+        }
+        if (closed){
+            return 0;
+        }
+        shmRingWait(&spins);
+    }
+}
+
+//Detaches. The producer's close marks the end of the trace;
+//the consumer's removes the segment
+void shmRingClose(shmRing *ring){
+    if (ring == NULL){
+        return;
+    }
+    if (ring->name != NULL){
+        shm_unlink(ring->name);
+        free(ring->name);
+    } else {
+        atomic_store_explicit(&ring->header->closed, 1, memory_order_release);
+    }
+    shmRingUnmap(ring);
+}
+
+/////////////////////////////////////////////////////
+// End of file
+/////////////////////////////////////////////////////
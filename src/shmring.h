@@ -0,0 +1,63 @@
+/////////////////////////////////////////////////////
+// CSC 252 Project 4
+// Cache Simulator
+// Wilfred Wallis and Chris Dalke
+/////////////////////////////////////////////////////
+// File: shmring.h
+/////////////////////////////////////////////////////
+
+#ifndef SHMRING_H
+#define SHMRING_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include "ring.h"
+#include "trace.h"
+
+#define SHMRING_MAGIC "CSIMSHM"
+#define SHMRING_VERSION 1
+
+//Records in a ring cacheSim creates
+#define SHMRING_DEFAULT_CAPACITY (1 << 20)
+
+//How long a producer waits for the segment to appear (ms)
+#define SHMRING_CONNECT_TIMEOUT 10000
+
+//One access as it crosses the process boundary, whatever ADDR_BITS is
+typedef struct {
+    uint64_t address;
+    uint32_t isStore;
+    uint32_t core;
+} shmRecord;
+
+//Start of the shared segment; the records follow it.
+//Same protocol as spscRing, with the indices shared between processes.
+typedef struct {
+    _Atomic uint32_t ready;     //set once the rest of the header is filled in
+    char magic[7];              //SHMRING_MAGIC without its terminator
+    uint8_t version;
+    uint32_t capacity;          //records, a power of two
+    _Alignas(RING_ALIGN) _Atomic uint64_t head; //next record to read, owned by the consumer
+    _Alignas(RING_ALIGN) _Atomic uint64_t tail; //next record to write, owned by the producer
+    _Alignas(RING_ALIGN) _Atomic uint32_t closed; //producer has written its last record
+} shmRingHeader;
+
+//One end of a ring
+typedef struct shmRing {
+    shmRingHeader *header;
+    shmRecord *records;
+    size_t mapSize;
+    char *name;                 //set on the consumer end, which removes the segment
+} shmRing;
+
+shmRing *shmRingCreate(const char *name, uint32_t capacity);
+shmRing *shmRingConnect(const char *name);
+void shmRingWrite(shmRing *ring, const traceRecord *records, uint32_t count);
+uint32_t shmRingRead(shmRing *ring, traceRecord *records, uint32_t maxRecords);
+void shmRingClose(shmRing *ring);
+
+#endif
+
+/////////////////////////////////////////////////////
+// End of file
+/////////////////////////////////////////////////////
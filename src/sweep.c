@@ -0,0 +1,350 @@
+/////////////////////////////////////////////////////
+// CSC 252 Project 4
+// Cache Simulator
+// Wilfred Wallis and Chris Dalke
+/////////////////////////////////////////////////////
+// File: sweep.c
+/////////////////////////////////////////////////////
+
+#include "cache.h"
+#include "trace.h"
+#include "sweep.h"
+
+/////////////////////////////////////////////////////
+// Single-pass LRU sweep
+//
+// An LRU cache of C blocks hits exactly when the block's
+// stack distance (number of distinct blocks touched since
+// its last use) is below C. We compute every access's
+// stack distance once, both over the whole cache and
+// within its set, and bucket them by bit length. Every
+// power-of-two size can then be read off the histograms.
+//
+// Stack distances are counted with a Fenwick tree that
+// marks the most recent access time of each block.
+// Only a block's latest time is marked, so once the
+// clock outruns the live blocks the times are renumbered
+// 1..live in order and the trees rebuilt. Memory then
+// follows the distinct blocks, not the trace length.
+/////////////////////////////////////////////////////
+
+/////////////////////////////////////////////////////
+// Fenwick tree functions
+// fenwickInit: creates an empty tree
+// fenwickAdd: adds delta at a position (1-based)
+// fenwickPrefix: sums positions 1..pos
+// fenwickGrow: doubles the tree until pos fits
+// fenwickRefill: resizes the tree to hold marks at 1..count
+/////////////////////////////////////////////////////
+
+void fenwickInit(fenwickTree *ft, uint64_t capacity){
+    ft->capacity = capacity;
+    ft->tree = calloc(capacity + 1, sizeof(uint32_t));
+}
+
+void fenwickAdd(fenwickTree *ft, uint64_t pos, int32_t delta){
+    for (; pos <= ft->capacity; pos += pos & (~pos + 1)){
+        ft->tree[pos] += delta;
+    }
+}
+
+uint64_t fenwickPrefix(const fenwickTree *ft, uint64_t pos){
+    uint64_t sum = 0;
+    for (; pos > 0; pos -= pos & (~pos + 1)){
+        sum += ft->tree[pos];
+    }
+    return sum;
+}
+
+//Doubling keeps every old node valid: new nodes below 2n only cover
+//new (empty) positions, and node 2n covers everything.
+void fenwickGrow(fenwickTree *ft, uint64_t pos){
+    while (pos > ft->capacity){
+        uint64_t oldCapacity = ft->capacity;
+        uint32_t total = (uint32_t)fenwickPrefix(ft, oldCapacity);
+        ft->capacity *= 2;
+        ft->tree = realloc(ft->tree, sizeof(uint32_t) * (ft->capacity + 1));
+        memset(ft->tree + oldCapacity + 1, 0, sizeof(uint32_t) * oldCapacity);
+        ft->tree[ft->capacity] = total;
+    }
+}
+
+//Positions 1..count each hold one; the capacity becomes the smallest power
+//of two at least minCapacity with room for the tree to double its contents
+void fenwickRefill(fenwickTree *ft, uint64_t count, uint64_t minCapacity){
+    uint64_t capacity = minCapacity;
+    while (capacity < count * 2){
+        capacity *= 2;
+    }
+    free(ft->tree);
+    ft->capacity = capacity;
+    ft->tree = malloc(sizeof(uint32_t) * (capacity + 1));
+
+    //Node i covers (i - lowbit(i), i]; count how much of that is marked
+    ft->tree[0] = 0;
+    for (uint64_t pos = 1; pos <= capacity; pos++){
+        uint64_t low = pos - (pos & (~pos + 1));
+        ft->tree[pos] = pos <= count ? pos - low : (low < count ? count - low : 0);
+    }
+}
+
+void fenwickFree(fenwickTree *ft){
+    free(ft->tree);
+}
+
+/////////////////////////////////////////////////////
+// Block history table
+// Open-addressing hash map from block number to the
+// time of its last access, globally and within its set.
+// A lastTime of 0 marks an empty slot.
+/////////////////////////////////////////////////////
+
+typedef struct {
+    addr_t block;
+    uint64_t lastTime;    //global time of last access
+    uint64_t lastSetTime; //per-set time of last access
+} sweepEntry;
+
+typedef struct {
+    sweepEntry *entries;
+    uint64_t mask;
+    uint64_t count;
+} sweepTable;
+
+static void sweepTableInit(sweepTable *st, uint64_t capacity){
+    st->entries = calloc(capacity, sizeof(sweepEntry));
+    st->mask = capacity - 1;
+    st->count = 0;
+}
+
+static sweepEntry *sweepTableFind(sweepTable *st, addr_t block){
+    uint64_t slot = (((uint64_t)block * 0x9E3779B97F4A7C15ull) >> 32) & st->mask;
+    while (st->entries[slot].lastTime != 0 && st->entries[slot].block != block){
+        slot = (slot + 1) & st->mask;
+    }
+    return &st->entries[slot];
+}
+
+//Rehashes into a table twice the size
+static void sweepTableGrow(sweepTable *st){
+    sweepTable bigger;
+    sweepTableInit(&bigger, (st->mask + 1) * 2);
+    for (uint64_t slot = 0; slot <= st->mask; slot++){
+        if (st->entries[slot].lastTime != 0){
+            *sweepTableFind(&bigger, st->entries[slot].block) = st->entries[slot];
+        }
+    }
+    bigger.count = st->count;
+    free(st->entries);
+    *st = bigger;
+}
+
+//Starting tree sizes, which are also the smallest a compaction leaves
+#define SWEEP_GLOBAL_CAPACITY 1024
+#define SWEEP_SET_CAPACITY 16
+
+//Renumbers every block's last access times to their rank among the live
+//ones, globally and within the set, and rebuilds the trees to match.
+//The clocks restart from the number of live blocks.
+static void sweepCompact(sweepTable *st, fenwickTree *globalTree, uint64_t *globalClock,
+                         fenwickTree *setTrees, uint64_t *setTimes, uint32_t numSets, uint32_t numIndexBits){
+    //A marked time's rank is the number of marks up to it
+    memset(setTimes, 0, sizeof(uint64_t) * numSets);
+    for (uint64_t slot = 0; slot <= st->mask; slot++){
+        sweepEntry *entry = &st->entries[slot];
+        if (entry->lastTime != 0){
+            uint32_t set = extractBitSequence(entry->block, 0, numIndexBits);
+            entry->lastTime = fenwickPrefix(globalTree, entry->lastTime);
+            entry->lastSetTime = fenwickPrefix(&setTrees[set], entry->lastSetTime);
+            setTimes[set]++;
+        }
+    }
+
+    fenwickRefill(globalTree, st->count, SWEEP_GLOBAL_CAPACITY);
+    *globalClock = st->count;
+    for (uint32_t set = 0; set < numSets; set++){
+        fenwickRefill(&setTrees[set], setTimes[set], SWEEP_SET_CAPACITY);
+    }
+}
+
+//Bit length of a distance, used as its histogram bucket
+static inline uint32_t bucketOf(uint64_t distance){
+    uint32_t bucket = 0;
+    while (distance){
+        distance >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+//Counts the misses a histogram implies for a cache of 2^sizeBits blocks
+static uint64_t missesAbove(const uint64_t hist[SWEEP_BUCKETS], uint32_t sizeBits){
+    uint64_t misses = 0;
+    for (uint32_t bucket = sizeBits + 1; bucket < SWEEP_BUCKETS; bucket++){
+        misses += hist[bucket];
+    }
+    return misses;
+}
+
+/////////////////////////////////////////////////////
+// runSweep: reads the trace once and prints LRU miss
+// rates for all power-of-two cache sizes, fully
+// associative and with numSets sets of 'line' bytes.
+/////////////////////////////////////////////////////
+
+int runSweep(char *filename, uint32_t line, uint32_t numSets){
+    uint32_t numOffsetBits = logBaseTwo(line);
+    uint32_t numIndexBits = logBaseTwo(numSets);
+
+    //Distance histograms. Cold (first) accesses are counted separately.
+    //jointHist[set bucket][global bucket] lets us split set-associative
+    //misses into capacity and conflict exactly as the simulator does.
+    uint64_t (*jointHist)[SWEEP_BUCKETS] = calloc(SWEEP_BUCKETS, sizeof(*jointHist));
+    uint64_t globalHist[SWEEP_BUCKETS] = {0};
+    uint64_t coldAccesses = 0;
+    uint64_t totalAccesses = 0;
+
+    if (traceOpen(filename)){
+        printf("Could not open trace file\n");
+        free(jointHist);
+        return -1;
+    }
+
+    //Global time and per-set time trees
+    fenwickTree globalTree;
+    fenwickInit(&globalTree, SWEEP_GLOBAL_CAPACITY);
+    uint64_t globalClock = 0;
+    fenwickTree *setTrees = malloc(sizeof(fenwickTree) * numSets);
+    uint64_t *setTimes = calloc(numSets, sizeof(uint64_t));
+    for (uint32_t set = 0; set < numSets; set++){
+        fenwickInit(&setTrees[set], SWEEP_SET_CAPACITY);
+    }
+
+    sweepTable history;
+    sweepTableInit(&history, 1024);
+
+    traceRecord *batch = malloc(sizeof(traceRecord) * TRACE_BATCH_SIZE);
+    uint32_t numRead;
+    while ((numRead = traceReadBatch(batch, TRACE_BATCH_SIZE)) > 0){
+        for (uint32_t r = 0; r < numRead; r++){
+            addr_t currentAddress = batch[r].address;
+            addr_t block = extractBitSequence(currentAddress, numOffsetBits, ADDR_BITS - numOffsetBits);
+            uint32_t set = extractBitSequence(currentAddress, numOffsetBits, numIndexBits);
+
+            //Compact rather than grow when at most half the global times are live
+            if (globalClock == globalTree.capacity && history.count * 2 <= globalTree.capacity){
+                sweepCompact(&history, &globalTree, &globalClock, setTrees, setTimes, numSets, numIndexBits);
+            }
+
+            totalAccesses++;
+            uint64_t now = ++globalClock;
+            uint64_t setNow = ++setTimes[set];
+            fenwickGrow(&globalTree, now);
+            fenwickGrow(&setTrees[set], setNow);
+
+            sweepEntry *entry = sweepTableFind(&history, block);
+            if (entry->lastTime == 0){
+                //First touch: compulsory miss at every size
+                coldAccesses++;
+                entry->block = block;
+                history.count++;
+            } else {
+                //Distinct blocks touched strictly between the two accesses
+                uint64_t globalDistance = fenwickPrefix(&globalTree, now - 1) - fenwickPrefix(&globalTree, entry->lastTime);
+                uint64_t setDistance = fenwickPrefix(&setTrees[set], setNow - 1) - fenwickPrefix(&setTrees[set], entry->lastSetTime);
+                uint32_t globalBucket = bucketOf(globalDistance);
+                globalHist[globalBucket]++;
+                jointHist[bucketOf(setDistance)][globalBucket]++;
+
+                fenwickAdd(&globalTree, entry->lastTime, -1);
+                fenwickAdd(&setTrees[set], entry->lastSetTime, -1);
+            }
+
+            //Mark this access as the block's most recent one
+            entry->lastTime = now;
+            entry->lastSetTime = setNow;
+            fenwickAdd(&globalTree, now, 1);
+            fenwickAdd(&setTrees[set], setNow, 1);
+
+            if (history.count * 2 > history.mask){
+                sweepTableGrow(&history);
+            }
+        }
+    }
+    free(batch);
+
+    traceClose();
+
+    /////////////////////////////////////////////////////
+    // Report
+    /////////////////////////////////////////////////////
+
+    //Largest bucket that still holds accesses; sizes beyond it add nothing
+    uint32_t maxGlobalBucket = 0;
+    uint32_t maxSetBucket = 0;
+    for (uint32_t setBucket = 0; setBucket < SWEEP_BUCKETS; setBucket++){
+        for (uint32_t globalBucket = 0; globalBucket < SWEEP_BUCKETS; globalBucket++){
+            if (jointHist[setBucket][globalBucket]){
+                if (setBucket > maxSetBucket) maxSetBucket = setBucket;
+                if (globalBucket > maxGlobalBucket) maxGlobalBucket = globalBucket;
+            }
+        }
+    }
+
+    double total = (double) totalAccesses;
+    printf("Sweep: Line Size: %uB; Accesses: %llu; Unique Blocks: %llu\n", line,
+           (unsigned long long) totalAccesses, (unsigned long long) history.count);
+
+    //Fully associative sizes, starting at one block
+    printf("Fully-associative LRU\n");
+    printf("%12s %12s %12s %12s\n", "Size(KB)", "Miss Rate", "Compulsory", "Capacity");
+    for (uint32_t sizeBits = 0; sizeBits <= maxGlobalBucket && sizeBits < 64; sizeBits++){
+        uint64_t capacity = missesAbove(globalHist, sizeBits);
+        double sizeKB = (double) line * (double) ((uint64_t)1 << sizeBits) / 1024.0;
+        printf("%12g %11lf%% %12llu %12llu\n", sizeKB, (coldAccesses + capacity) / total * 100.0,
+               (unsigned long long) coldAccesses, (unsigned long long) capacity);
+    }
+
+    //Set-associative sizes: fixed sets, ways doubling
+    printf("Set-associative LRU (%u sets)\n", numSets);
+    printf("%12s %8s %12s %12s %12s %12s\n", "Size(KB)", "Ways", "Miss Rate", "Compulsory", "Capacity", "Conflict");
+    for (uint32_t waysBits = 0; waysBits <= maxSetBucket && waysBits + numIndexBits < 64; waysBits++){
+        //A non-cold access misses when its set distance reaches the ways.
+        //It is a conflict miss if a fully associative cache of the same size would hit.
+        uint32_t sizeBits = waysBits + numIndexBits;
+        uint64_t capacity = 0;
+        uint64_t conflict = 0;
+        for (uint32_t setBucket = waysBits + 1; setBucket < SWEEP_BUCKETS; setBucket++){
+            for (uint32_t globalBucket = 0; globalBucket < SWEEP_BUCKETS; globalBucket++){
+                if (globalBucket > sizeBits){
+                    capacity += jointHist[setBucket][globalBucket];
+                } else {
+                    conflict += jointHist[setBucket][globalBucket];
+                }
+            }
+        }
+        double sizeKB = (double) line * (double) ((uint64_t)1 << sizeBits) / 1024.0;
+        printf("%12g %8llu %11lf%% %12llu %12llu %12llu\n", sizeKB, (unsigned long long)1 << waysBits,
+               (coldAccesses + capacity + conflict) / total * 100.0, (unsigned long long) coldAccesses,
+               (unsigned long long) capacity, (unsigned long long) conflict);
+    }
+
+    /////////////////////////////////////////////////////
+    // Cleanup
+    /////////////////////////////////////////////////////
+
+    for (uint32_t set = 0; set < numSets; set++){
+        fenwickFree(&setTrees[set]);
+    }
+    free(setTrees);
+    free(setTimes);
+    fenwickFree(&globalTree);
+    free(history.entries);
+    free(jointHist);
+
+    return 0;
+}
+
+/////////////////////////////////////////////////////
+// End of file
+/////////////////////////////////////////////////////
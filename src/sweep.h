@@ -0,0 +1,38 @@
+/////////////////////////////////////////////////////
+// CSC 252 Project 4
+// Cache Simulator
+// Wilfred Wallis and Chris Dalke
+/////////////////////////////////////////////////////
+// File: sweep.h
+/////////////////////////////////////////////////////
+
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include <stdint.h>
+
+//Number of histogram buckets: one per possible bit length of a distance
+#define SWEEP_BUCKETS 65
+
+//Fenwick (binary indexed) tree over access times
+//Grows by doubling, so the trace length need not be known up front,
+//and can be refilled with renumbered times to shrink it again
+typedef struct {
+    uint32_t *tree;
+    uint64_t capacity; //always a power of two
+} fenwickTree;
+
+void fenwickInit(fenwickTree *ft, uint64_t capacity);
+void fenwickAdd(fenwickTree *ft, uint64_t pos, int32_t delta);
+uint64_t fenwickPrefix(const fenwickTree *ft, uint64_t pos);
+void fenwickGrow(fenwickTree *ft, uint64_t pos);
+void fenwickRefill(fenwickTree *ft, uint64_t count, uint64_t minCapacity);
+void fenwickFree(fenwickTree *ft);
+
+int runSweep(char *filename, uint32_t line, uint32_t numSets);
+
+#endif
+
+/////////////////////////////////////////////////////
+// End of file
+/////////////////////////////////////////////////////
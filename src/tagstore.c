@@ -0,0 +1,281 @@
+/////////////////////////////////////////////////////
+// CSC 252 Project 4
+// Cache Simulator
+// Wilfred Wallis and Chris Dalke
+/////////////////////////////////////////////////////
+// File: tagstore.c
+/////////////////////////////////////////////////////
+
+#include "cache.h"
+#include "tagstore.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define TAGSTORE_X86 1
+#include <immintrin.h>
+#endif
+
+/////////////////////////////////////////////////////
+// Set search kernels
+//
+// A lookup compares the incoming key against every way
+// of one set. Keys fold the valid bit in (empty ways are
+// 0), so one 64-bit compare per way is the whole test,
+// and searching for key 0 finds an empty way.
+//
+// Each kernel has copies specialized for 1, 2, 4, 8 and
+// 16 ways plus a generic one. The vector kernels compare
+// four ways per step; AVX2 also
+// finds the oldest way for FIFO/LRU with a vector min.
+// tagStoreSelect picks the best copy for the CPU once,
+// when a model is set up.
+/////////////////////////////////////////////////////
+
+//ISA requested with -simd; never more than the CPU has
+static uint32_t requestedIsa = TAGSTORE_AUTO;
+
+static const char * const isaNames[] = { "auto", "scalar", "sse2", "avx2" };
+
+/////////////////////////////////////////////////////
+// Scalar kernels
+/////////////////////////////////////////////////////
+
+static inline uint32_t scalarFind(const cacheLine *set, uint32_t ways, uint64_t key){
+    for (uint32_t currentWay = 0; currentWay < ways; currentWay++){
+        if (set[currentWay].key == key){
+            return currentWay;
+        }
+    }
+    return ways;
+}
+
+static inline uint32_t scalarOldest(const cacheLine *set, uint32_t ways){
+    uint32_t selectedWay = 0;
+    uint32_t lowestAge = set[0].age;
+    for (uint32_t currentWay = 1; currentWay < ways; currentWay++){
+        if (set[currentWay].age < lowestAge){
+            lowestAge = set[currentWay].age;
+            selectedWay = currentWay;
+        }
+    }
+    return selectedWay;
+}
+
+/////////////////////////////////////////////////////
+// SSE2 kernel: two keys per compare
+/////////////////////////////////////////////////////
+
+#ifdef TAGSTORE_X86
+__attribute__((target("sse2")))
+static inline uint32_t sse2Find(const cacheLine *set, uint32_t ways, uint64_t key){
+    __m128i wanted = _mm_set1_epi64x(key);
+    uint32_t currentWay = 0;
+    for (; currentWay + 4 <= ways; currentWay += 4){
+        __m128i way0 = _mm_loadu_si128((const __m128i *)&set[currentWay]);
+        __m128i way1 = _mm_loadu_si128((const __m128i *)&set[currentWay + 1]);
+        __m128i way2 = _mm_loadu_si128((const __m128i *)&set[currentWay + 2]);
+        __m128i way3 = _mm_loadu_si128((const __m128i *)&set[currentWay + 3]);
+
+        //SSE2 has no 64-bit compare: compare 32-bit halves, pack to 16 bits,
+        //and a key matches when all four of its mask bits are set
+        __m128i equal01 = _mm_cmpeq_epi32(_mm_unpacklo_epi64(way0, way1), wanted);
+        __m128i equal23 = _mm_cmpeq_epi32(_mm_unpacklo_epi64(way2, way3), wanted);
+        uint32_t mask = _mm_movemask_epi8(_mm_packs_epi32(equal01, equal23));
+        mask &= mask >> 2;
+        mask &= mask >> 1;
+        mask &= 0x1111;
+        if (mask){
+            return currentWay + __builtin_ctz(mask) / 4;
+        }
+    }
+    for (; currentWay < ways; currentWay++){
+        if (set[currentWay].key == key){
+            return currentWay;
+        }
+    }
+    return ways;
+}
+
+/////////////////////////////////////////////////////
+// AVX2 kernels: four keys per compare
+/////////////////////////////////////////////////////
+
+__attribute__((target("avx2")))
+static inline uint32_t avx2Find(const cacheLine *set, uint32_t ways, uint64_t key){
+    __m256i wanted = _mm256_set1_epi64x(key);
+    uint32_t currentWay = 0;
+    for (; currentWay + 4 <= ways; currentWay += 4){
+        __m256i low = _mm256_loadu_si256((const __m256i *)&set[currentWay]);
+        __m256i high = _mm256_loadu_si256((const __m256i *)&set[currentWay + 2]);
+
+        //Unpacking within 128-bit lanes leaves the keys of ways 0, 2, 1, 3
+        __m256i keys = _mm256_unpacklo_epi64(low, high);
+        int mask = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(keys, wanted)));
+        if (mask){
+            int ordered = (mask & 9) | ((mask & 2) << 1) | ((mask & 4) >> 1);
+            return currentWay + __builtin_ctz(ordered);
+        }
+    }
+    for (; currentWay < ways; currentWay++){
+        if (set[currentWay].key == key){
+            return currentWay;
+        }
+    }
+    return ways;
+}
+
+__attribute__((target("avx2")))
+static inline uint32_t avx2Oldest(const cacheLine *set, uint32_t ways){
+    //Ages are the third 32-bit word of each way; other words are forced to the maximum
+    const __m256i ageWords = _mm256_setr_epi32(0, 0, -1, 0, 0, 0, -1, 0);
+    const __m256i otherWords = _mm256_xor_si256(ageWords, _mm256_set1_epi32(-1));
+
+    //First pass: the lowest age
+    __m256i lowest = _mm256_set1_epi32(-1);
+    uint32_t currentWay = 0;
+    for (; currentWay + 2 <= ways; currentWay += 2){
+        __m256i pair = _mm256_loadu_si256((const __m256i *)&set[currentWay]);
+        lowest = _mm256_min_epu32(lowest, _mm256_or_si256(pair, otherWords));
+    }
+    uint32_t lowestAge = (uint32_t)_mm256_extract_epi32(lowest, 2);
+    if ((uint32_t)_mm256_extract_epi32(lowest, 6) < lowestAge){
+        lowestAge = (uint32_t)_mm256_extract_epi32(lowest, 6);
+    }
+    if (currentWay < ways && set[currentWay].age < lowestAge){
+        return currentWay;
+    }
+
+    //Second pass: the first way with that age
+    __m256i wanted = _mm256_set1_epi32((int)lowestAge);
+    for (currentWay = 0; currentWay + 2 <= ways; currentWay += 2){
+        __m256i pair = _mm256_loadu_si256((const __m256i *)&set[currentWay]);
+        __m256i equal = _mm256_and_si256(_mm256_cmpeq_epi32(pair, wanted), ageWords);
+        int mask = _mm256_movemask_ps(_mm256_castsi256_ps(equal));
+        if (mask){
+            return currentWay + ((mask & 4) ? 0 : 1);
+        }
+    }
+    return currentWay;
+}
+#endif
+
+/////////////////////////////////////////////////////
+// Specializations
+// Each wrapper fixes the way count, so the inlined
+// kernel's loops are fully unrolled.
+/////////////////////////////////////////////////////
+
+#define FIXED_FIND(kernel, n, attributes) \
+    attributes static uint32_t kernel##n(const cacheLine *set, uint32_t ways, uint64_t key){ \
+        (void)ways; \
+        return kernel(set, n, key); \
+    }
+#define FIXED_OLDEST(kernel, n, attributes) \
+    attributes static uint32_t kernel##n(const cacheLine *set, uint32_t ways){ \
+        (void)ways; \
+        return kernel(set, n); \
+    }
+#define GENERIC_FIND(kernel, attributes) \
+    attributes static uint32_t kernel##Any(const cacheLine *set, uint32_t ways, uint64_t key){ \
+        return kernel(set, ways, key); \
+    }
+#define GENERIC_OLDEST(kernel, attributes) \
+    attributes static uint32_t kernel##Any(const cacheLine *set, uint32_t ways){ \
+        return kernel(set, ways); \
+    }
+
+FIXED_FIND(scalarFind, 1, )
+FIXED_FIND(scalarFind, 2, )
+FIXED_FIND(scalarFind, 4, )
+FIXED_FIND(scalarFind, 8, )
+FIXED_FIND(scalarFind, 16, )
+GENERIC_FIND(scalarFind, )
+FIXED_OLDEST(scalarOldest, 1, )
+FIXED_OLDEST(scalarOldest, 2, )
+FIXED_OLDEST(scalarOldest, 4, )
+FIXED_OLDEST(scalarOldest, 8, )
+FIXED_OLDEST(scalarOldest, 16, )
+GENERIC_OLDEST(scalarOldest, )
+
+#ifdef TAGSTORE_X86
+FIXED_FIND(sse2Find, 4, __attribute__((target("sse2"))))
+FIXED_FIND(sse2Find, 8, __attribute__((target("sse2"))))
+FIXED_FIND(sse2Find, 16, __attribute__((target("sse2"))))
+GENERIC_FIND(sse2Find, __attribute__((target("sse2"))))
+FIXED_FIND(avx2Find, 4, __attribute__((target("avx2"))))
+FIXED_FIND(avx2Find, 8, __attribute__((target("avx2"))))
+FIXED_FIND(avx2Find, 16, __attribute__((target("avx2"))))
+GENERIC_FIND(avx2Find, __attribute__((target("avx2"))))
+FIXED_OLDEST(avx2Oldest, 2, __attribute__((target("avx2"))))
+FIXED_OLDEST(avx2Oldest, 4, __attribute__((target("avx2"))))
+FIXED_OLDEST(avx2Oldest, 8, __attribute__((target("avx2"))))
+FIXED_OLDEST(avx2Oldest, 16, __attribute__((target("avx2"))))
+GENERIC_OLDEST(avx2Oldest, __attribute__((target("avx2"))))
+#endif
+
+//Kernels per ISA, indexed by log2(ways) for 1..16 ways; the last entry is generic
+static const tagFindFunc scalarFinds[6] = { scalarFind1, scalarFind2, scalarFind4, scalarFind8, scalarFind16, scalarFindAny };
+static const tagOldestFunc scalarOldests[6] = { scalarOldest1, scalarOldest2, scalarOldest4, scalarOldest8, scalarOldest16, scalarOldestAny };
+#ifdef TAGSTORE_X86
+//Fewer than four ways don't fill a vector
+static const tagFindFunc sse2Finds[6] = { scalarFind1, scalarFind2, sse2Find4, sse2Find8, sse2Find16, sse2FindAny };
+static const tagFindFunc avx2Finds[6] = { scalarFind1, scalarFind2, avx2Find4, avx2Find8, avx2Find16, avx2FindAny };
+static const tagOldestFunc avx2Oldests[6] = { scalarOldest1, avx2Oldest2, avx2Oldest4, avx2Oldest8, avx2Oldest16, avx2OldestAny };
+#endif
+
+//Best ISA this CPU supports
+static uint32_t tagStoreDetect(void){
+#ifdef TAGSTORE_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")){
+        return TAGSTORE_AVX2;
+    }
+    if (__builtin_cpu_supports("sse2")){
+        return TAGSTORE_SSE2;
+    }
+#endif
+    return TAGSTORE_SCALAR;
+}
+
+//Limits the kernels to one ISA by name (auto, scalar, sse2, avx2)
+//Returns -1 for an unknown name
+int tagStoreSetIsa(const char *name){
+    for (uint32_t isa = TAGSTORE_AUTO; isa <= TAGSTORE_AVX2; isa++){
+        if (!strcmp(name, isaNames[isa])){
+            requestedIsa = isa;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+const char *tagStoreIsaName(uint32_t isa){
+    return isa <= TAGSTORE_AVX2 ? isaNames[isa] : "unknown";
+}
+
+void tagStoreSelect(tagSearch *search, uint32_t ways){
+    uint32_t isa = tagStoreDetect();
+    if (requestedIsa != TAGSTORE_AUTO && requestedIsa < isa){
+        isa = requestedIsa;
+    }
+
+    uint32_t slot = 5;
+    if (ways <= 16 && (ways & (ways - 1)) == 0){
+        slot = logBaseTwo(ways);
+    }
+
+    search->isa = isa;
+    search->find = scalarFinds[slot];
+    search->oldest = scalarOldests[slot];
+#ifdef TAGSTORE_X86
+    if (isa == TAGSTORE_SSE2){
+        search->find = sse2Finds[slot];
+    } else if (isa == TAGSTORE_AVX2){
+        search->find = avx2Finds[slot];
+        search->oldest = avx2Oldests[slot];
+    }
+#endif
+}
+
+/////////////////////////////////////////////////////
+// End of file
+/////////////////////////////////////////////////////
@@ -0,0 +1,59 @@
+/////////////////////////////////////////////////////
+// CSC 252 Project 4
+// Cache Simulator
+// Wilfred Wallis and Chris Dalke
+/////////////////////////////////////////////////////
+// File: tagstore.h
+/////////////////////////////////////////////////////
+
+#ifndef TAGSTORE_H
+#define TAGSTORE_H
+
+#include <stdint.h>
+
+//Host cache line size the tag store is aligned to
+#define HOST_CACHE_LINE 64
+
+//Line flags
+#define LINE_DIRTY 1
+#define LINE_SHARED 2    //other caches may hold the block (MESI S state)
+#define LINE_TRACKED 4   //writes to the block are recorded for false-sharing analysis
+#define LINE_PREFETCHED 8 //filled by a prefetch and not yet used by a demand access
+
+//One way of one set. Four fit in a host cache line.
+typedef struct {
+    uint64_t key;    //(tag << 1) | 1 when the way is valid, 0 when empty
+    uint32_t age;    //replacement stamp from ageClock, or RRPV for the RRIP policies
+    uint32_t flags;  //LINE_* bits
+} cacheLine;
+
+//Key a valid way holding 'tag' would have
+#define LINE_KEY(tag) (((uint64_t)(tag) << 1) | 1)
+
+//Instruction sets the set search can use
+#define TAGSTORE_AUTO 0
+#define TAGSTORE_SCALAR 1
+#define TAGSTORE_SSE2 2
+#define TAGSTORE_AVX2 3
+
+//Finds the way holding a key, or returns ways if it is not in the set
+typedef uint32_t (*tagFindFunc)(const cacheLine *set, uint32_t ways, uint64_t key);
+//Finds the first way with the lowest age
+typedef uint32_t (*tagOldestFunc)(const cacheLine *set, uint32_t ways);
+
+//Set search kernels chosen for one associativity on this CPU
+typedef struct {
+    tagFindFunc find;
+    tagOldestFunc oldest;
+    uint32_t isa;    //TAGSTORE_SCALAR, TAGSTORE_SSE2 or TAGSTORE_AVX2
+} tagSearch;
+
+int tagStoreSetIsa(const char *name);
+void tagStoreSelect(tagSearch *search, uint32_t ways);
+const char *tagStoreIsaName(uint32_t isa);
+
+#endif
+
+/////////////////////////////////////////////////////
+// End of file
+/////////////////////////////////////////////////////
@@ -7,51 +7,826 @@
 /////////////////////////////////////////////////////
 
 #include "trace.h"
+#include "shmring.h"
 
 //Variable declarations
 FILE *traceFile;
-FILE *outputFile;
 char *inputLine;
 const size_t MAX_LINE_SIZE = 300;
 
+//Memory-mapped trace, when the input is a regular file
+const char *traceMap;
+size_t traceMapSize;
+size_t traceMapPos;
+
+//Value of each hex digit character, 0xFF for anything else
+uint8_t hexValue[256];
+
+//Shared-memory ring, when the trace comes from another process
+shmRing *traceRing;
+
+//Binary trace decoder state
+int traceBinary;
+uint32_t traceAddressWidth;
+uint64_t traceRecordsLeft;
+uint64_t tracePrevAddress;
+uint64_t traceChecksum;
+uint64_t traceExpectedChecksum;
+uint32_t traceHasChecksum;
+uint32_t traceHasCores;
+uint32_t traceMalformed;    //a varint ran past its longest legal encoding or the end of the input
+
+//Longest legal varints: 6 + 9 * 7 bits cover an address, 5 * 7 bits a core ID
+#define TRACE_ADDRESS_SHIFT_LIMIT 64
+#define TRACE_CORE_SHIFT_LIMIT 32
+
 /////////////////////////////////////////////////////
 // Trace functions
-// traceOpen: opens a new trace file
+// traceOpen: opens a new trace file, mapping it if possible.
+//   "-" reads standard input and "shm:/name" a shared-memory ring
+// traceResultBase: name to give result files for a trace
 // traceReadLine: reads the next line. Returns null if done.
+// traceReadBatch: decodes up to N records. Returns 0 if done.
+// traceIdentify: record count and checksum of a trace just opened
 // traceClose: closes the trace file
+// traceLoad: parses a whole trace into an array (NULL if it can't be opened)
+// traceCoalesce: groups runs of accesses to one block
+// traceConvert: writes a trace in the binary format
+// traceWriterOpen/Write/Close: build a binary trace from records
+//
+// Text lines are "<l|s> 0x<address>", optionally followed
+// by the decimal ID of the core that issued the access.
+//
+// Binary traces start with a traceHeader and hold one
+// varint per record. The first byte carries the store
+// bit in bit 0 and six bits of the zigzag-encoded address
+// delta; continuation bytes carry seven more bits each.
+// With TRACE_FLAG_CORES a plain varint core ID follows.
 /////////////////////////////////////////////////////
 
-void traceOpen(char *filename){
-	traceFile = fopen(filename, "r");
+//FNV-1a, folded over the payload one byte at a time
+#define FNV_OFFSET 14695981039346656037ull
+#define FNV_PRIME 1099511628211ull
+
+//Mask of the low 'width' bits of an address
+static inline uint64_t traceWidthMask(uint32_t width){
+	return width >= 64 ? ~(uint64_t)0 : (((uint64_t)1 << width) - 1);
+}
+
+//Validates a header and sets up the binary decoder
+static int traceStartBinary(const traceHeader *header){
+	if (header->version != TRACE_BINARY_VERSION || header->addressWidth == 0){
+		return -1;
+	}
+	if (header->addressWidth > ADDR_BITS){
+		fprintf(stderr, "Trace has %u-bit addresses; build cacheSim64 to read it\n", header->addressWidth);
+		return -1;
+	}
+	traceBinary = 1;
+	traceAddressWidth = header->addressWidth;
+	traceRecordsLeft = header->recordCount;
+	tracePrevAddress = 0;
+	traceChecksum = FNV_OFFSET;
+	traceHasChecksum = header->flags & TRACE_FLAG_CHECKSUM;
+	traceHasCores = (header->flags & TRACE_FLAG_CORES) != 0;
+	traceExpectedChecksum = header->checksum;
+	traceMalformed = 0;
+	return 0;
+}
+
+int traceOpen(char *filename){
+	//Build the hex digit table
+	memset(hexValue, 0xFF, sizeof(hexValue));
+	for (int digit = 0; digit < 10; digit++){
+		hexValue['0' + digit] = digit;
+	}
+	for (int digit = 0; digit < 6; digit++){
+		hexValue['a' + digit] = 10 + digit;
+		hexValue['A' + digit] = 10 + digit;
+	}
+
+	traceMap = NULL;
+	traceMapSize = 0;
+	traceMapPos = 0;
+	traceFile = NULL;
+	inputLine = NULL;
+	traceBinary = 0;
+	traceRing = NULL;
+
+	//Live traces from another process arrive through a ring it fills
+	if (!strncmp(filename, TRACE_SHM_PREFIX, strlen(TRACE_SHM_PREFIX))){
+		traceRing = shmRingCreate(filename + strlen(TRACE_SHM_PREFIX), SHMRING_DEFAULT_CAPACITY);
+		if (traceRing == NULL){
+			return -1;
+		}
+		fprintf(stderr, "Waiting for accesses on %s\n", filename);
+		return 0;
+	}
+
+	//Regular files are mapped and split in place; standard input and pipes are streamed
+	int fd = !strcmp(filename, TRACE_STDIN) ? dup(STDIN_FILENO) : open(filename, O_RDONLY);
+	if (fd < 0){
+		return -1;
+	}
+	struct stat info;
+	if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode)){
+		traceMapSize = info.st_size;
+		if (traceMapSize > 0){
+			void *map = mmap(NULL, traceMapSize, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (map != MAP_FAILED){
+				madvise(map, traceMapSize, MADV_SEQUENTIAL);
+				traceMap = map;
+			}
+		} else {
+			//Nothing to read; an empty map is never touched
+			traceMap = "";
+		}
+	}
+	if (traceMap != NULL){
+		close(fd);
+
+		//Binary traces are recognized by their magic number
+		if (traceMapSize >= sizeof(traceHeader) && !memcmp(traceMap, TRACE_MAGIC, sizeof(TRACE_MAGIC) - 1)){
+			traceHeader header;
+			memcpy(&header, traceMap, sizeof(header));
+			traceMapPos = sizeof(header);
+			if (traceStartBinary(&header)){
+				traceClose();
+				return -1;
+			}
+		}
+		return 0;
+	}
+
+	//Pipes and other non-seekable input fall back to stream reads
+	traceFile = fdopen(fd, "r");
 	inputLine = malloc(MAX_LINE_SIZE);
+
+	//Text lines never start with the magic's first character, so one byte of lookahead is enough
+	int first = getc(traceFile);
+	if (first == TRACE_MAGIC[0]){
+		traceHeader header;
+		header.magic[0] = first;
+		if (fread(header.magic + 1, sizeof(header) - 1, 1, traceFile) != 1
+			|| memcmp(header.magic, TRACE_MAGIC, sizeof(TRACE_MAGIC) - 1)
+			|| traceStartBinary(&header)){
+			traceClose();
+			return -1;
+		}
+	} else if (first != EOF){
+		ungetc(first, traceFile);
+	}
+	return 0;
+}
+
+//Result files go beside a trace file; live traces put them in the current directory
+const char *traceResultBase(const char *filename){
+	if (!strcmp(filename, TRACE_STDIN)){
+		return "stdin";
+	}
+	if (!strncmp(filename, TRACE_SHM_PREFIX, strlen(TRACE_SHM_PREFIX))){
+		const char *name = filename + strlen(TRACE_SHM_PREFIX);
+		while (*name == '/'){
+			name++;
+		}
+		return *name ? name : "shm";
+	}
+	return filename;
 }
 
 char * traceReadLine(){
 	return fgets(inputLine, MAX_LINE_SIZE, traceFile);
 }
 
+//Decodes one "<type> 0x<hex>" line starting at *cursor
+//Returns 1 and advances past the newline if a record was found
+static inline int traceDecodeLine(const char **cursor, const char *end, traceRecord *record){
+	const char *p = *cursor;
+
+	//Skip blank lines
+	while (p < end && (*p == '\n' || *p == '\r')){
+		p++;
+	}
+	if (p >= end){
+		*cursor = p;
+		return 0;
+	}
+
+	record->isStore = (*p == 's');
+	p += 2;
+
+	//Skip the 0x prefix, then fold in digits until a non-hex character
+	if (p + 1 < end && p[0] == '0' && (p[1] | 0x20) == 'x'){
+		p += 2;
+	}
+	addr_t address = 0;
+	uint8_t digit;
+	while (p < end && (digit = hexValue[(uint8_t)*p]) != 0xFF){
+		address = (address << 4) | digit;
+		p++;
+	}
+	record->address = address;
+
+	//An optional core ID follows the address
+	while (p < end && (*p == ' ' || *p == '\t')){
+		p++;
+	}
+	uint32_t core = 0;
+	while (p < end && *p >= '0' && *p <= '9'){
+		core = core * 10 + (*p - '0');
+		p++;
+	}
+	record->core = core;
+
+	//Move on to the next line
+	while (p < end && *p++ != '\n');
+
+	*cursor = p;
+	return 1;
+}
+
+//Turns one decoded varint into a record
+static inline void traceApplyDelta(uint64_t zigzag, uint32_t isStore, traceRecord *record){
+	int64_t delta = (int64_t)(zigzag >> 1) ^ -(int64_t)(zigzag & 1);
+	tracePrevAddress = (tracePrevAddress + delta) & traceWidthMask(traceAddressWidth);
+	record->address = tracePrevAddress;
+	record->isStore = isStore;
+	record->core = 0;
+}
+
+//Decodes binary records from the mapped file
+static uint32_t traceReadBinaryMapped(traceRecord *records, uint32_t maxRecords){
+	const uint8_t *p = (const uint8_t *)traceMap + traceMapPos;
+	const uint8_t *end = (const uint8_t *)traceMap + traceMapSize;
+	uint64_t checksum = traceChecksum;
+	uint32_t count = 0;
+
+	while (count < maxRecords && traceRecordsLeft > 0 && p < end){
+		uint8_t byte = *p++;
+		checksum = (checksum ^ byte) * FNV_PRIME;
+		uint32_t isStore = byte & 1;
+		uint64_t zigzag = (byte >> 1) & 0x3F;
+		uint32_t shift = 6;
+		while ((byte & 0x80) && p < end && shift < TRACE_ADDRESS_SHIFT_LIMIT){
+			byte = *p++;
+			checksum = (checksum ^ byte) * FNV_PRIME;
+			zigzag |= (uint64_t)(byte & 0x7F) << shift;
+			shift += 7;
+		}
+		if (byte & 0x80){
+			traceMalformed = 1;
+			break;
+		}
+		traceApplyDelta(zigzag, isStore, &records[count]);
+		if (traceHasCores){
+			uint32_t core = 0;
+			shift = 0;
+			do {
+				if (shift >= TRACE_CORE_SHIFT_LIMIT || p >= end){
+					traceMalformed = 1;
+					break;
+				}
+				byte = *p++;
+				checksum = (checksum ^ byte) * FNV_PRIME;
+				core |= (uint32_t)(byte & 0x7F) << shift;
+				shift += 7;
+			} while (byte & 0x80);
+			if (traceMalformed){
+				break;
+			}
+			records[count].core = core;
+		}
+		count++;
+		traceRecordsLeft--;
+	}
+
+	traceMapPos = p - (const uint8_t *)traceMap;
+	traceChecksum = checksum;
+	return count;
+}
+
+//Decodes binary records from a stream
+static uint32_t traceReadBinaryStream(traceRecord *records, uint32_t maxRecords){
+	uint32_t count = 0;
+	int byte;
+
+	while (count < maxRecords && traceRecordsLeft > 0 && (byte = getc(traceFile)) != EOF){
+		traceChecksum = (traceChecksum ^ byte) * FNV_PRIME;
+		uint32_t isStore = byte & 1;
+		uint64_t zigzag = (byte >> 1) & 0x3F;
+		uint32_t shift = 6;
+		while ((byte & 0x80) && shift < TRACE_ADDRESS_SHIFT_LIMIT && (byte = getc(traceFile)) != EOF){
+			traceChecksum = (traceChecksum ^ byte) * FNV_PRIME;
+			zigzag |= (uint64_t)(byte & 0x7F) << shift;
+			shift += 7;
+		}
+		if (byte == EOF || (byte & 0x80)){
+			traceMalformed = 1;
+			break;
+		}
+		traceApplyDelta(zigzag, isStore, &records[count]);
+		if (traceHasCores){
+			uint32_t core = 0;
+			shift = 0;
+			do {
+				if (shift >= TRACE_CORE_SHIFT_LIMIT){
+					traceMalformed = 1;
+					break;
+				}
+				byte = getc(traceFile);
+				if (byte == EOF){
+					traceMalformed = 1;
+					break;
+				}
+				traceChecksum = (traceChecksum ^ byte) * FNV_PRIME;
+				core |= (uint32_t)(byte & 0x7F) << shift;
+				shift += 7;
+			} while (byte & 0x80);
+			if (traceMalformed){
+				break;
+			}
+			records[count].core = core;
+		}
+		count++;
+		traceRecordsLeft--;
+	}
+	return count;
+}
+
+uint32_t traceReadBatch(traceRecord *records, uint32_t maxRecords){
+	uint32_t count = 0;
+
+	if (traceRing != NULL){
+		return shmRingRead(traceRing, records, maxRecords);
+	}
+
+	if (traceBinary){
+		count = traceMap != NULL ? traceReadBinaryMapped(records, maxRecords) : traceReadBinaryStream(records, maxRecords);
+
+		//A cut-off or overlong record ends the trace; the records before it stand
+		if (traceMalformed){
+			fprintf(stderr, "Warning: binary trace is truncated or corrupt\n");
+			traceRecordsLeft = 0;
+			traceMalformed = 0;
+			traceHasChecksum = 0;
+			return count;
+		}
+		if (count == 0 && traceHasChecksum){
+			if (traceRecordsLeft > 0 || traceChecksum != traceExpectedChecksum){
+				fprintf(stderr, "Warning: binary trace is truncated or corrupt\n");
+			}
+			traceHasChecksum = 0; //only warn once
+		}
+		return count;
+	}
+
+	if (traceMap != NULL){
+		const char *cursor = traceMap + traceMapPos;
+		const char *end = traceMap + traceMapSize;
+		while (count < maxRecords && traceDecodeLine(&cursor, end, &records[count])){
+			count++;
+		}
+		traceMapPos = cursor - traceMap;
+		return count;
+	}
+
+	while (count < maxRecords && traceReadLine() != NULL){
+		const char *cursor = inputLine;
+		if (traceDecodeLine(&cursor, inputLine + strlen(inputLine), &records[count])){
+			count++;
+		}
+	}
+	return count;
+}
+
+//Identifies the trace just opened, for checkpoints: its record count and, for
+//binary traces, the payload checksum (0 for text). Returns -1 for live input
+//and streamed binary traces, whose length isn't known until the end.
+int traceIdentify(uint64_t *records, uint64_t *checksum){
+	*records = 0;
+	*checksum = 0;
+	if (traceMap == NULL){
+		return -1;
+	}
+	if (traceBinary){
+		if (!traceHasChecksum){
+			return -1;
+		}
+		*records = traceRecordsLeft;
+		*checksum = traceExpectedChecksum;
+		return 0;
+	}
+
+	//Every line that isn't blank is one record
+	const char *p = traceMap;
+	const char *end = traceMap + traceMapSize;
+	while (p < end){
+		*records += *p != '\n' && *p != '\r';
+		const char *newline = memchr(p, '\n', end - p);
+		p = newline != NULL ? newline + 1 : end;
+	}
+	return 0;
+}
+
+//Reads past up to count records without returning them; returns how many were skipped.
+//Used to line the trace up with a restored checkpoint.
+uint64_t traceSkip(uint64_t count){
+	traceRecord *records = malloc(sizeof(traceRecord) * TRACE_BATCH_SIZE);
+	uint64_t skipped = 0;
+	uint32_t numRead;
+
+	while (skipped < count && (numRead = traceReadBatch(records, count - skipped < TRACE_BATCH_SIZE ? count - skipped : TRACE_BATCH_SIZE)) > 0){
+		skipped += numRead;
+	}
+	free(records);
+	return skipped;
+}
+
+//Splits records into runs of consecutive accesses by one core to one block of
+//2^offsetBits bytes; runs must have room for count entries. Returns the number of runs.
+//Runs found for one line size are also runs for every larger one.
+uint32_t traceCoalesce(const traceRecord *records, uint32_t count, uint32_t offsetBits, traceRun *runs){
+	uint32_t numRuns = 0;
+	uint32_t r = 0;
+
+	while (r < count){
+		addr_t block = records[r].address >> offsetBits;
+		uint32_t core = records[r].core;
+		uint32_t end = r + 1;
+		uint32_t stores = 0;
+		while (end < count && (records[end].address >> offsetBits) == block && records[end].core == core){
+			stores += records[end].isStore != 0;
+			end++;
+		}
+		runs[numRuns].first = r;
+		runs[numRuns].length = end - r;
+		runs[numRuns].stores = stores;
+		numRuns++;
+		r = end;
+	}
+	return numRuns;
+}
+
 void traceClose(){
-	fclose(traceFile);
-	free(inputLine);
+	shmRingClose(traceRing);
+	traceRing = NULL;
+	if (traceMap != NULL){
+		if (traceMapSize > 0){
+			munmap((void *)traceMap, traceMapSize);
+		}
+		traceMap = NULL;
+	} else if (traceFile != NULL){
+		fclose(traceFile);
+		free(inputLine);
+		traceFile = NULL;
+	}
+	traceBinary = 0;
+}
+
+traceRecord * traceLoad(char *filename, uint64_t *count){
+	uint64_t capacity = 1 << 16;
+	*count = 0;
+	if (traceOpen(filename)){
+		return NULL;
+	}
+	traceRecord *records = malloc(sizeof(traceRecord) * capacity);
+	for (;;){
+		if (capacity - *count < TRACE_BATCH_SIZE){
+			capacity *= 2;
+			records = realloc(records, sizeof(traceRecord) * capacity);
+		}
+		uint32_t numRead = traceReadBatch(records + *count, TRACE_BATCH_SIZE);
+		if (numRead == 0){
+			break;
+		}
+		*count += numRead;
+	}
+	traceClose();
+
+	return records;
+}
+
+//Appends one record to the output as a varint
+static inline void traceEncodeRecord(FILE *file, const traceRecord *record, uint64_t *prevAddress, uint32_t width, uint32_t withCore, uint64_t *checksum){
+	//Signed distance from the previous address, wrapped to the address width
+	uint64_t diff = ((uint64_t)record->address - *prevAddress) & traceWidthMask(width);
+	int64_t delta = width < 64 && (diff >> (width - 1)) ? (int64_t)(diff | ~traceWidthMask(width)) : (int64_t)diff;
+	uint64_t zigzag = ((uint64_t)delta << 1) ^ (uint64_t)(delta >> 63);
+	*prevAddress = record->address;
+
+	uint8_t bytes[18];
+	uint32_t numBytes = 0;
+	bytes[numBytes] = (record->isStore ? 1 : 0) | ((zigzag & 0x3F) << 1);
+	zigzag >>= 6;
+	while (zigzag){
+		bytes[numBytes++] |= 0x80;
+		bytes[numBytes] = zigzag & 0x7F;
+		zigzag >>= 7;
+	}
+	numBytes++;
+
+	if (withCore){
+		uint32_t core = record->core;
+		while (core >= 0x80){
+			bytes[numBytes++] = (core & 0x7F) | 0x80;
+			core >>= 7;
+		}
+		bytes[numBytes++] = core;
+	}
+
+	for (uint32_t b = 0; b < numBytes; b++){
+		*checksum = (*checksum ^ bytes[b]) * FNV_PRIME;
+	}
+	fwrite(bytes, 1, numBytes, file);
+}
+
+//Creates a binary trace; a placeholder header is written now
+//and completed with the count and checksum on close
+int traceWriterOpen(traceWriter *writer, char *filename, uint32_t withCores){
+	memset(&writer->header, 0, sizeof(writer->header));
+	writer->file = NULL;
+	writer->ring = NULL;
+	writer->streaming = 0;
+
+	//Records for a shared-memory ring are handed over as they are
+	if (!strncmp(filename, TRACE_SHM_PREFIX, strlen(TRACE_SHM_PREFIX))){
+		writer->ring = shmRingConnect(filename + strlen(TRACE_SHM_PREFIX));
+		return writer->ring == NULL ? -1 : 0;
+	}
+
+	//Standard output and pipes cannot be rewound to finish the header,
+	//so theirs says "read to the end" and carries no checksum
+	if (!strcmp(filename, TRACE_STDIN)){
+		writer->file = fdopen(dup(STDOUT_FILENO), "wb");
+	} else {
+		writer->file = fopen(filename, "wb");
+	}
+	if (writer->file == NULL){
+		return -1;
+	}
+	struct stat info;
+	writer->streaming = fstat(fileno(writer->file), &info) != 0 || !S_ISREG(info.st_mode);
+	memcpy(writer->header.magic, TRACE_MAGIC, sizeof(writer->header.magic));
+	writer->header.version = TRACE_BINARY_VERSION;
+	writer->header.addressWidth = ADDR_BITS;
+	writer->header.flags = (writer->streaming ? 0 : TRACE_FLAG_CHECKSUM) | (withCores ? TRACE_FLAG_CORES : 0);
+	writer->header.recordCount = writer->streaming ? TRACE_COUNT_STREAM : 0;
+	fwrite(&writer->header, sizeof(writer->header), 1, writer->file);
+	writer->header.recordCount = 0;
+	writer->prevAddress = 0;
+	writer->checksum = FNV_OFFSET;
+	return 0;
+}
+
+void traceWriterWrite(traceWriter *writer, const traceRecord *records, uint32_t count){
+	writer->header.recordCount += count;
+	if (writer->ring != NULL){
+		shmRingWrite(writer->ring, records, count);
+		return;
+	}
+	uint32_t withCores = (writer->header.flags & TRACE_FLAG_CORES) != 0;
+	for (uint32_t r = 0; r < count; r++){
+		traceEncodeRecord(writer->file, &records[r], &writer->prevAddress, writer->header.addressWidth, withCores, &writer->checksum);
+	}
+}
+
+//Finishes the header and closes the file; returns its size in bytes.
+//A ring producer's close marks the end of the trace, and returns 0
+long traceWriterClose(traceWriter *writer){
+	if (writer->ring != NULL){
+		shmRingClose(writer->ring);
+		writer->ring = NULL;
+		return 0;
+	}
+	writer->header.checksum = writer->checksum;
+	long outputSize = ftell(writer->file);
+	if (!writer->streaming){
+		fseek(writer->file, 0, SEEK_SET);
+		fwrite(&writer->header, sizeof(writer->header), 1, writer->file);
+	}
+	fclose(writer->file);
+	writer->file = NULL;
+	return outputSize;
+}
+
+//Whether any record of the open trace names a core other than 0
+//Reads the whole trace, so only call it on a mapped file
+static int traceScanCores(void){
+	traceRecord *batch = malloc(sizeof(traceRecord) * TRACE_BATCH_SIZE);
+	int found = 0;
+	uint32_t numRead;
+	while (!found && (numRead = traceReadBatch(batch, TRACE_BATCH_SIZE)) > 0){
+		for (uint32_t r = 0; r < numRead; r++){
+			found |= batch[r].core != 0;
+		}
+	}
+	free(batch);
+	return found;
+}
+
+int traceConvert(char *inputFilename, char *outputFilename){
+	if (traceOpen(inputFilename)){
+		printf("Could not open trace file\n");
+		return -1;
+	}
+
+	//Core IDs are only stored if the trace has any. A stream can't be
+	//read twice, so it keeps them without looking.
+	uint32_t withCores = 1;
+	if (traceMap != NULL){
+		withCores = traceScanCores();
+		traceClose();
+		traceOpen(inputFilename);
+	}
+	traceWriter writer;
+	if (traceWriterOpen(&writer, outputFilename, withCores)){
+		traceClose();
+		printf("Could not open output file\n");
+		return -1;
+	}
+
+	traceRecord *batch = malloc(sizeof(traceRecord) * TRACE_BATCH_SIZE);
+	uint32_t numRead;
+	while ((numRead = traceReadBatch(batch, TRACE_BATCH_SIZE)) > 0){
+		traceWriterWrite(&writer, batch, numRead);
+	}
+	free(batch);
+	traceClose();
+
+	uint64_t recordCount = writer.header.recordCount;
+	long outputSize = traceWriterClose(&writer);
+
+	//Keep standard output clean when the trace itself went there
+	FILE *report = strcmp(outputFilename, TRACE_STDIN) ? stdout : stderr;
+	if (outputSize > 0){
+		fprintf(report, "Converted %llu records: %ld bytes (%.2f bytes/record)\n", (unsigned long long) recordCount,
+			outputSize, recordCount ? (double) outputSize / recordCount : 0.0);
+	} else {
+		fprintf(report, "Converted %llu records\n", (unsigned long long) recordCount);
+	}
+	return 0;
 }
 
 /////////////////////////////////////////////////////
 // Output functions
-// outputOpen: opens a new output file
-// outputWrite: writes a line to the output file
-// outputClose: closes the output file
+// outputOpen: opens a result file in the given mode
+// outputWriteBatch: writes the outcome of each record
+// outputClose: flushes and closes the result file
+// outputExtension: file extension used for a mode
+//
+// Results are formatted straight into one reusable
+// buffer that is flushed with fwrite when nearly full.
+// Records no longer carry their trace line, so text
+// output writes each access in canonical form: "l" or
+// "s", then the address as lowercase hex with at least
+// eight digits. Traces already in that form (as the
+// course traces are) come out exactly as they went in;
+// others are normalized, and core IDs are only kept
+// with OUTPUT_CORES.
+// OUTPUT_BINARY packs each outcome code into two bits,
+// four accesses per byte, after an outcomeHeader;
+// with OUTPUT_WIDE it uses four bits, two per byte.
 /////////////////////////////////////////////////////
 
-void outputOpen(char *filename){
-	outputFile = fopen(filename, "w");
+//Labels appended to each line in text mode, indexed by outcome
+static const char * const outcomeTags[5] = {
+	" hit\n",        //HIT_SUCCESS
+	" conflict\n",   //CONFLICT_MISS
+	" compulsory\n", //COMPULSORY_MISS
+	" capacity\n",   //CAPACITY_MISS
+	" coherence\n",  //COHERENCE_MISS
+};
+static const char hexDigits[] = "0123456789abcdef";
+
+//Longest text line we ever format
+#define OUTPUT_MAX_LINE 64
+
+static void outputFlush(resultWriter *writer){
+	fwrite(writer->buffer, 1, writer->used, writer->file);
+	writer->used = 0;
+}
+
+int outputOpen(resultWriter *writer, char *filename, uint32_t mode){
+	writer->flags = mode & (OUTPUT_WIDE | OUTPUT_CORES);
+	mode &= ~(OUTPUT_WIDE | OUTPUT_CORES);
+	writer->mode = mode;
+	writer->file = NULL;
+	writer->buffer = NULL;
+	writer->used = 0;
+	writer->packed = 0;
+	writer->packedCount = 0;
+	writer->numOutcomes = 0;
+	if (mode == OUTPUT_NONE){
+		return 0;
+	}
+
+	writer->file = fopen(filename, mode == OUTPUT_BINARY ? "wb" : "w");
+	if (writer->file == NULL){
+		return -1;
+	}
+	writer->buffer = malloc(OUTPUT_BUFFER_SIZE);
+
+	//The count is filled in when the file is closed
+	if (mode == OUTPUT_BINARY){
+		outcomeHeader header;
+		memset(&header, 0, sizeof(header));
+		memcpy(header.magic, OUTCOME_MAGIC, sizeof(header.magic));
+		header.version = (writer->flags & OUTPUT_WIDE) ? OUTCOME_WIDE_VERSION : OUTCOME_BINARY_VERSION;
+		fwrite(&header, sizeof(header), 1, writer->file);
+	}
+	return 0;
 }
 
-void outputWrite(char *text){
-	fputs(text,outputFile);
+void outputWriteBatch(resultWriter *writer, const traceRecord *records, const uint8_t *outcomes, uint32_t count){
+	if (writer->mode == OUTPUT_NONE){
+		return;
+	}
+	writer->numOutcomes += count;
+
+	if (writer->mode == OUTPUT_BINARY){
+		uint32_t bits = (writer->flags & OUTPUT_WIDE) ? 4 : 2;
+		uint32_t perByte = 8 / bits;
+		uint8_t codeMask = (1 << bits) - 1;
+		for (uint32_t r = 0; r < count; r++){
+			writer->packed |= (outcomes[r] & codeMask) << (bits * writer->packedCount);
+			if (++writer->packedCount == perByte){
+				if (writer->used == OUTPUT_BUFFER_SIZE){
+					outputFlush(writer);
+				}
+				writer->buffer[writer->used++] = writer->packed;
+				writer->packed = 0;
+				writer->packedCount = 0;
+			}
+		}
+		return;
+	}
+
+	for (uint32_t r = 0; r < count; r++){
+		if (OUTPUT_BUFFER_SIZE - writer->used < OUTPUT_MAX_LINE){
+			outputFlush(writer);
+		}
+		char *p = writer->buffer + writer->used;
+		addr_t address = records[r].address;
+
+		//"<type> 0x<address>", the address with at least eight digits
+		*p++ = records[r].isStore ? 's' : 'l';
+		*p++ = ' ';
+		*p++ = '0';
+		*p++ = 'x';
+		int digits = 8;
+		while (digits < ADDR_BITS / 4 && (address >> (4 * digits)) != 0){
+			digits++;
+		}
+		for (int d = digits - 1; d >= 0; d--){
+			*p++ = hexDigits[(address >> (4 * d)) & 0xF];
+		}
+		if (writer->flags & OUTPUT_CORES){
+			p += sprintf(p, " %u", records[r].core);
+		}
+
+		//Then the tag for what happened to this access
+		const char *tag = outcomeTags[outcomes[r] <= COHERENCE_MISS ? outcomes[r] : HIT_SUCCESS];
+		while (*tag){
+			*p++ = *tag++;
+		}
+
+		writer->used = p - writer->buffer;
+	}
+}
+
+void outputClose(resultWriter *writer){
+	if (writer->file == NULL){
+		return;
+	}
+
+	if (writer->mode == OUTPUT_BINARY){
+		//Flush a partly filled last byte, then record the count
+		if (writer->packedCount > 0){
+			if (writer->used == OUTPUT_BUFFER_SIZE){
+				outputFlush(writer);
+			}
+			writer->buffer[writer->used++] = writer->packed;
+		}
+		outputFlush(writer);
+
+		outcomeHeader header;
+		memset(&header, 0, sizeof(header));
+		memcpy(header.magic, OUTCOME_MAGIC, sizeof(header.magic));
+		header.version = (writer->flags & OUTPUT_WIDE) ? OUTCOME_WIDE_VERSION : OUTCOME_BINARY_VERSION;
+		header.outcomeCount = writer->numOutcomes;
+		fseek(writer->file, 0, SEEK_SET);
+		fwrite(&header, sizeof(header), 1, writer->file);
+	} else {
+		outputFlush(writer);
+	}
+
+	fclose(writer->file);
+	free(writer->buffer);
+	writer->file = NULL;
 }
 
-void outputClose(){
-	fclose(outputFile);
+const char * outputExtension(uint32_t mode){
+	return mode == OUTPUT_BINARY ? ".outcomes" : ".simulated";
 }
 
 /////////////////////////////////////////////////////
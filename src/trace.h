@@ -6,21 +6,125 @@
 // File: trace.h
 /////////////////////////////////////////////////////
 
+#ifndef TRACE_H
+#define TRACE_H
+
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <ctype.h>
 #include <string.h>
 #include <assert.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "cache.h"
+
+//Number of records traceReadBatch is usually asked for
+#define TRACE_BATCH_SIZE 4096
+
+//Binary trace format
+#define TRACE_MAGIC "CSIMTRC"
+#define TRACE_BINARY_VERSION 1
+#define TRACE_FLAG_CHECKSUM 1
+#define TRACE_FLAG_CORES 2      //each record is followed by a varint core ID
+#define TRACE_COUNT_STREAM UINT64_MAX //recordCount of a trace written to a pipe: read to the end
+
+//Trace names that are not files
+#define TRACE_STDIN "-"         //standard input, text or binary
+#define TRACE_SHM_PREFIX "shm:" //shm:/name, a shared-memory ring a producer fills
+
+//Header at the start of a binary trace (little-endian)
+typedef struct {
+    char magic[7];          //TRACE_MAGIC without its terminator
+    uint8_t version;
+    uint8_t addressWidth;   //bits per address
+    uint8_t flags;          //TRACE_FLAG_*
+    uint16_t reserved;
+    uint32_t reserved2;
+    uint64_t recordCount;
+    uint64_t checksum;      //FNV-1a of the payload bytes
+} traceHeader;
+
+struct shmRing;
+
+//Writer for a binary trace, or for the producer end of a shared-memory ring
+typedef struct {
+    FILE *file;
+    struct shmRing *ring;   //set instead of file for shm:/name
+    uint32_t streaming;     //output cannot be rewound, so the header is final from the start
+    traceHeader header;     //recordCount grows as records are written
+    uint64_t prevAddress;   //records are stored as deltas
+    uint64_t checksum;
+} traceWriter;
 
+//Per-access result file modes
+#define OUTPUT_TEXT 0    //GOLD-compatible "<l|s> 0x<address> <outcome>" text, the address rewritten in canonical form
+#define OUTPUT_BINARY 1  //two bits per access, the outcome code
+#define OUTPUT_NONE 2    //statistics only
+//Flags combined with a mode
+#define OUTPUT_WIDE 4    //binary: four bits per access, for codes above 3
+#define OUTPUT_CORES 8   //text: write each access's core ID after its address
 
-void traceOpen(char *filename);
+#define OUTPUT_BUFFER_SIZE (1 << 20)
+#define OUTCOME_MAGIC "CSIMOUT"
+#define OUTCOME_BINARY_VERSION 1
+#define OUTCOME_WIDE_VERSION 2  //two outcomes per payload byte
+
+//Header at the start of a binary outcome file (little-endian)
+typedef struct {
+    char magic[7];          //OUTCOME_MAGIC without its terminator
+    uint8_t version;
+    uint64_t outcomeCount;  //accesses recorded; four per payload byte (two if wide)
+} outcomeHeader;
+
+//Buffered writer for one result file
+typedef struct {
+    FILE *file;
+    uint32_t mode;
+    uint32_t flags;         //OUTPUT_WIDE / OUTPUT_CORES
+    char *buffer;
+    size_t used;
+    uint8_t packed;         //OUTPUT_BINARY: outcomes not yet written
+    uint32_t packedCount;
+    uint64_t numOutcomes;
+} resultWriter;
+
+//One pre-parsed trace access
+typedef struct {
+    addr_t address;
+    uint32_t isStore;
+    uint32_t core;          //issuing core; 0 for single-core traces
+} traceRecord;
+
+//Back-to-back records from one core to one block, from traceCoalesce
+typedef struct {
+    uint32_t first;         //index of the run's first record
+    uint32_t length;        //records in the run
+    uint32_t stores;        //stores among the records after the first
+} traceRun;
+
+int traceOpen(char *filename);
+const char *traceResultBase(const char *filename);
 char * traceReadLine();
+uint32_t traceReadBatch(traceRecord *records, uint32_t maxRecords);
+int traceIdentify(uint64_t *records, uint64_t *checksum);
+uint64_t traceSkip(uint64_t count);
+uint32_t traceCoalesce(const traceRecord *records, uint32_t count, uint32_t offsetBits, traceRun *runs);
 void traceClose();
+traceRecord *traceLoad(char *filename, uint64_t *count);
+int traceConvert(char *inputFilename, char *outputFilename);
+int traceWriterOpen(traceWriter *writer, char *filename, uint32_t withCores);
+void traceWriterWrite(traceWriter *writer, const traceRecord *records, uint32_t count);
+long traceWriterClose(traceWriter *writer);
+
+int outputOpen(resultWriter *writer, char *filename, uint32_t mode);
+void outputWriteBatch(resultWriter *writer, const traceRecord *records, const uint8_t *outcomes, uint32_t count);
+void outputClose(resultWriter *writer);
+const char * outputExtension(uint32_t mode);
 
-void outputOpen(char *filename);
-void outputWrite(char *text);
-void outputClose();
+#endif
 
 /////////////////////////////////////////////////////
 // End of file
@@ -0,0 +1,117 @@
+/////////////////////////////////////////////////////
+// CSC 252 Project 4
+// Cache Simulator
+// Wilfred Wallis and Chris Dalke
+/////////////////////////////////////////////////////
+// File: victim.c
+/////////////////////////////////////////////////////
+
+#include "cache.h"
+#include "victim.h"
+
+/////////////////////////////////////////////////////
+// Victim cache (Jouppi)
+//
+// Sits between the cache and memory. Every block the
+// cache evicts goes in here; a cache miss that finds
+// its block here swaps it back instead of going to
+// memory. Only dirty blocks leaving the victim cache
+// are written back.
+/////////////////////////////////////////////////////
+
+//Sets up an empty victim cache; NULL on failure
+victimCache *victimCreate(uint32_t numEntries){
+    if (numEntries == 0 || numEntries > VICTIM_MAX_ENTRIES){
+        return NULL;
+    }
+    victimCache *vc = calloc(1, sizeof(victimCache));
+    if (vc == NULL){
+        return NULL;
+    }
+    vc->blocks = calloc(numEntries, sizeof(addr_t));
+    vc->dirty = calloc(numEntries, sizeof(uint32_t));
+    vc->ages = calloc(numEntries, sizeof(uint64_t));
+    if (vc->blocks == NULL || vc->dirty == NULL || vc->ages == NULL){
+        victimFree(vc);
+        return NULL;
+    }
+    vc->numEntries = numEntries;
+    return vc;
+}
+
+//Removes a block if it is held, setting *dirty. Returns 1 if it was there
+int victimTake(victimCache *vc, addr_t block, uint32_t *dirty){
+    for (uint32_t e = 0; e < vc->numEntries; e++){
+        if (vc->ages[e] != 0 && vc->blocks[e] == block){
+            *dirty = vc->dirty[e];
+            vc->ages[e] = 0;
+            vc->hits++;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+//Adds a block the cache evicted, pushing out the least recently inserted
+//entry if all are taken. Returns 1 and fills in the out parameters if one was
+int victimInsert(victimCache *vc, addr_t block, uint32_t dirty, addr_t *outBlock, uint32_t *outDirty){
+    uint32_t selected = 0;
+    for (uint32_t e = 1; e < vc->numEntries && vc->ages[selected] != 0; e++){
+        if (vc->ages[e] < vc->ages[selected]){
+            selected = e;
+        }
+    }
+    int displaced = vc->ages[selected] != 0;
+    if (displaced){
+        *outBlock = vc->blocks[selected];
+        *outDirty = vc->dirty[selected];
+        vc->writebacks += vc->dirty[selected] != 0;
+    }
+    vc->blocks[selected] = block;
+    vc->dirty[selected] = dirty != 0;
+    vc->ages[selected] = ++vc->clock;
+    vc->insertions++;
+    return displaced;
+}
+
+//Saves the entries and counts; returns 0 on success
+int victimWrite(const victimCache *vc, FILE *file){
+    uint64_t counts[6] = { vc->clock, vc->hits, vc->conflictRemoved, vc->capacityRemoved, vc->insertions, vc->writebacks };
+    int failed = fwrite(counts, sizeof(counts), 1, file) != 1
+              || fwrite(vc->blocks, sizeof(addr_t), vc->numEntries, file) != vc->numEntries
+              || fwrite(vc->dirty, sizeof(uint32_t), vc->numEntries, file) != vc->numEntries
+              || fwrite(vc->ages, sizeof(uint64_t), vc->numEntries, file) != vc->numEntries;
+    return failed ? -1 : 0;
+}
+
+//Loads victimWrite's output into a victim cache of the same size
+int victimRead(victimCache *vc, FILE *file){
+    uint64_t counts[6];
+    if (fread(counts, sizeof(counts), 1, file) != 1
+        || fread(vc->blocks, sizeof(addr_t), vc->numEntries, file) != vc->numEntries
+        || fread(vc->dirty, sizeof(uint32_t), vc->numEntries, file) != vc->numEntries
+        || fread(vc->ages, sizeof(uint64_t), vc->numEntries, file) != vc->numEntries){
+        return -1;
+    }
+    vc->clock = counts[0];
+    vc->hits = counts[1];
+    vc->conflictRemoved = counts[2];
+    vc->capacityRemoved = counts[3];
+    vc->insertions = counts[4];
+    vc->writebacks = counts[5];
+    return 0;
+}
+
+void victimFree(victimCache *vc){
+    if (vc == NULL){
+        return;
+    }
+    free(vc->blocks);
+    free(vc->dirty);
+    free(vc->ages);
+    free(vc);
+}
+
+/////////////////////////////////////////////////////
+// End of file
+/////////////////////////////////////////////////////
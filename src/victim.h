@@ -0,0 +1,47 @@
+/////////////////////////////////////////////////////
+// CSC 252 Project 4
+// Cache Simulator
+// Wilfred Wallis and Chris Dalke
+/////////////////////////////////////////////////////
+// File: victim.h
+/////////////////////////////////////////////////////
+
+#ifndef VICTIM_H
+#define VICTIM_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include "cache.h"
+
+//Most entries -victim accepts
+#define VICTIM_MAX_ENTRIES 64
+
+//Small fully-associative cache of blocks the main cache evicted. A hit takes
+//the entry out, so replacing the oldest insertion is also LRU
+typedef struct {
+    addr_t *blocks;         //block number of each entry
+    uint32_t *dirty;        //1 if the entry still has to be written back
+    uint64_t *ages;         //last use stamp, 0 for an empty entry
+    uint32_t numEntries;
+    uint64_t clock;
+
+    //Statistics
+    uint64_t hits;              //main cache misses the victim cache supplied
+    uint64_t conflictRemoved;   //hits on misses a fully-associative cache would not have had
+    uint64_t capacityRemoved;   //hits on misses that were down to capacity
+    uint64_t insertions;        //blocks evicted into it
+    uint64_t writebacks;        //dirty entries pushed out to memory
+} victimCache;
+
+victimCache *victimCreate(uint32_t numEntries);
+int victimTake(victimCache *vc, addr_t block, uint32_t *dirty);
+int victimInsert(victimCache *vc, addr_t block, uint32_t dirty, addr_t *outBlock, uint32_t *outDirty);
+int victimWrite(const victimCache *vc, FILE *file);
+int victimRead(victimCache *vc, FILE *file);
+void victimFree(victimCache *vc);
+
+#endif
+
+/////////////////////////////////////////////////////
+// End of file
+/////////////////////////////////////////////////////
@@ -0,0 +1,90 @@
+/////////////////////////////////////////////////////
+// CSC 252 Project 4
+// Cache Simulator
+// Wilfred Wallis and Chris Dalke
+/////////////////////////////////////////////////////
+// File: waypred.c
+/////////////////////////////////////////////////////
+
+#include "cache.h"
+#include "waypred.h"
+
+/////////////////////////////////////////////////////
+// Way prediction
+//
+// A set-associative lookup normally compares every
+// way's tag at once. A way predictor reads one way
+// first and only searches the rest when it is wrong,
+// trading a slower mispredicted hit for fewer tag
+// comparisons. The MRU predictor guesses the way its
+// set used last; the hash predictor, having no PC to
+// go on, keys a table on the block address instead.
+// Predictions never change what hits or misses.
+/////////////////////////////////////////////////////
+
+static const char * const waypredNames[NUM_WAYPREDS] = { "none", "mru", "hash" };
+
+//Returns the predictor with this name, or -1
+int waypredParse(const char *name){
+    for (int kind = 0; kind < NUM_WAYPREDS; kind++){
+        if (!strcmp(name, waypredNames[kind])){
+            return kind;
+        }
+    }
+    return -1;
+}
+
+const char *waypredName(uint32_t kind){
+    return kind < NUM_WAYPREDS ? waypredNames[kind] : "unknown";
+}
+
+//Sets up a predictor for a cache of numSets sets; NULL on failure
+wayPredictor *waypredCreate(uint32_t kind, uint32_t numSets, uint32_t ways){
+    if (kind == WAYPRED_NONE || kind >= NUM_WAYPREDS || ways > 256){
+        return NULL;
+    }
+    wayPredictor *wp = calloc(1, sizeof(wayPredictor));
+    if (wp == NULL){
+        return NULL;
+    }
+    wp->kind = kind;
+    uint64_t size = kind == WAYPRED_MRU ? numSets : ((uint64_t)1 << WAYPRED_HASH_BITS);
+    wp->mask = size - 1;
+    wp->table = calloc(size, sizeof(uint8_t));
+    if (wp->table == NULL){
+        free(wp);
+        return NULL;
+    }
+    return wp;
+}
+
+//Saves the table and counts; returns 0 on success
+int waypredWrite(const wayPredictor *wp, FILE *file){
+    uint64_t counts[2] = { wp->predictions, wp->correct };
+    int failed = fwrite(counts, sizeof(counts), 1, file) != 1
+              || fwrite(wp->table, sizeof(uint8_t), wp->mask + 1, file) != wp->mask + 1;
+    return failed ? -1 : 0;
+}
+
+//Loads waypredWrite's output into a predictor of the same kind and size
+int waypredRead(wayPredictor *wp, FILE *file){
+    uint64_t counts[2];
+    if (fread(counts, sizeof(counts), 1, file) != 1 || fread(wp->table, sizeof(uint8_t), wp->mask + 1, file) != wp->mask + 1){
+        return -1;
+    }
+    wp->predictions = counts[0];
+    wp->correct = counts[1];
+    return 0;
+}
+
+void waypredFree(wayPredictor *wp){
+    if (wp == NULL){
+        return;
+    }
+    free(wp->table);
+    free(wp);
+}
+
+/////////////////////////////////////////////////////
+// End of file
+/////////////////////////////////////////////////////
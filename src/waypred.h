@@ -0,0 +1,55 @@
+/////////////////////////////////////////////////////
+// CSC 252 Project 4
+// Cache Simulator
+// Wilfred Wallis and Chris Dalke
+/////////////////////////////////////////////////////
+// File: waypred.h
+/////////////////////////////////////////////////////
+
+#ifndef WAYPRED_H
+#define WAYPRED_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include "cache.h"
+
+//Way predictors for -way-predict
+#define WAYPRED_NONE 0
+#define WAYPRED_MRU 1      //the way the set used last
+#define WAYPRED_HASH 2     //the way a hash of the block address last mapped to
+#define NUM_WAYPREDS 3
+
+//Entries in the hash predictor's table
+#define WAYPRED_HASH_BITS 12
+
+//Guesses which way will hit, so only that tag is compared first
+typedef struct {
+    uint32_t kind;
+    uint8_t *table;         //predicted way per set (MRU) or per hash bucket
+    uint64_t mask;          //table size - 1
+
+    //Statistics
+    uint64_t predictions;   //accesses that hit, where a prediction can be right
+    uint64_t correct;
+} wayPredictor;
+
+int waypredParse(const char *name);
+const char *waypredName(uint32_t kind);
+wayPredictor *waypredCreate(uint32_t kind, uint32_t numSets, uint32_t ways);
+int waypredWrite(const wayPredictor *wp, FILE *file);
+int waypredRead(wayPredictor *wp, FILE *file);
+void waypredFree(wayPredictor *wp);
+
+//Table entry for an access to this set and block
+static inline uint64_t waypredSlot(const wayPredictor *wp, uint32_t indexBits, addr_t block){
+    if (wp->kind == WAYPRED_MRU){
+        return indexBits;
+    }
+    return (((uint64_t)block * 0x9E3779B97F4A7C15ull) >> (64 - WAYPRED_HASH_BITS)) & wp->mask;
+}
+
+#endif
+
+/////////////////////////////////////////////////////
+// End of file
+/////////////////////////////////////////////////////
@@ -0,0 +1,153 @@
+/////////////////////////////////////////////////////
+// CSC 252 Project 4
+// Cache Simulator
+// Wilfred Wallis and Chris Dalke
+/////////////////////////////////////////////////////
+// File: writebuf.c
+/////////////////////////////////////////////////////
+
+#include "cache.h"
+#include "writebuf.h"
+
+/////////////////////////////////////////////////////
+// Write buffer
+//
+// Writes bound for memory wait here, one entry per
+// block. A write to a block that already has an entry
+// merges into it, so several stores to one line cost a
+// single memory transaction. The simulator has no clock,
+// so entries drain only when a new block needs room:
+// the oldest is written out, carrying the bytes its
+// mask says were written.
+/////////////////////////////////////////////////////
+
+//Mask bits per entry; long lines get coarser chunks
+#define WRITEBUF_CHUNKS 64
+
+//Sets up an empty buffer for a cache with the given line size; NULL on failure
+writeBuffer *writeBufferCreate(uint32_t entries, uint32_t line){
+    if (entries == 0 || entries > WRITEBUF_MAX_ENTRIES || line == 0){
+        return NULL;
+    }
+    writeBuffer *wb = calloc(1, sizeof(writeBuffer));
+    if (wb == NULL){
+        return NULL;
+    }
+    wb->blocks = calloc(entries, sizeof(addr_t));
+    wb->masks = calloc(entries, sizeof(uint64_t));
+    if (wb->blocks == NULL || wb->masks == NULL){
+        writeBufferFree(wb);
+        return NULL;
+    }
+    wb->capacity = entries;
+    wb->offsetBits = logBaseTwo(line);
+    wb->chunkShift = line > WRITEBUF_CHUNKS ? wb->offsetBits - logBaseTwo(WRITEBUF_CHUNKS) : 0;
+    return wb;
+}
+
+//Bytes an entry carries to memory
+static inline uint32_t writeBufferEntryBytes(const writeBuffer *wb, uint64_t mask){
+    return (uint32_t)__builtin_popcountll(mask) << wb->chunkShift;
+}
+
+//Mask of the chunks covering [offset, offset + bytes) within a block
+static inline uint64_t writeBufferMask(const writeBuffer *wb, uint32_t offset, uint32_t bytes){
+    uint32_t first = offset >> wb->chunkShift;
+    uint32_t last = (offset + bytes - 1) >> wb->chunkShift;
+    uint32_t numChunks = last - first + 1;
+    return (numChunks >= 64 ? ~(uint64_t)0 : (((uint64_t)1 << numChunks) - 1)) << first;
+}
+
+//Puts a write of 'bytes' at 'address' in the buffer.
+//Returns the bytes of the entry drained to make room, or 0 if none was
+uint32_t writeBufferPut(writeBuffer *wb, addr_t address, uint32_t bytes){
+    addr_t block = address >> wb->offsetBits;
+    uint32_t offset = address & (((addr_t)1 << wb->offsetBits) - 1);
+    uint32_t lineBytes = 1u << wb->offsetBits;
+    if (offset + bytes > lineBytes){
+        bytes = lineBytes - offset;
+    }
+    uint64_t mask = writeBufferMask(wb, offset, bytes);
+    wb->writes++;
+
+    //Merge with a waiting entry for the same block
+    for (uint32_t e = 0; e < wb->count; e++){
+        uint32_t slot = (wb->head + e) % wb->capacity;
+        if (wb->blocks[slot] == block){
+            wb->masks[slot] |= mask;
+            wb->coalesced++;
+            return 0;
+        }
+    }
+
+    //Make room by writing out the oldest entry
+    uint32_t drained = 0;
+    if (wb->count == wb->capacity){
+        drained = writeBufferEntryBytes(wb, wb->masks[wb->head]);
+        wb->drains++;
+        wb->drainedBytes += drained;
+        wb->head = (wb->head + 1) % wb->capacity;
+        wb->count--;
+    }
+    uint32_t slot = (wb->head + wb->count) % wb->capacity;
+    wb->blocks[slot] = block;
+    wb->masks[slot] = mask;
+    wb->count++;
+    return drained;
+}
+
+//Bytes still waiting in the buffer at the end of the trace
+uint64_t writeBufferPendingBytes(const writeBuffer *wb){
+    uint64_t bytes = 0;
+    for (uint32_t e = 0; e < wb->count; e++){
+        bytes += writeBufferEntryBytes(wb, wb->masks[(wb->head + e) % wb->capacity]);
+    }
+    return bytes;
+}
+
+//Saves the waiting entries, oldest first, and the counts; returns 0 on success
+int writeBufferWrite(const writeBuffer *wb, FILE *file){
+    uint64_t counts[4] = { wb->writes, wb->coalesced, wb->drains, wb->drainedBytes };
+    int failed = fwrite(counts, sizeof(counts), 1, file) != 1
+              || fwrite(&wb->count, sizeof(wb->count), 1, file) != 1;
+    for (uint32_t e = 0; e < wb->count && !failed; e++){
+        uint32_t slot = (wb->head + e) % wb->capacity;
+        failed = fwrite(&wb->blocks[slot], sizeof(addr_t), 1, file) != 1
+              || fwrite(&wb->masks[slot], sizeof(uint64_t), 1, file) != 1;
+    }
+    return failed ? -1 : 0;
+}
+
+//Loads writeBufferWrite's output into an empty buffer of the same size
+int writeBufferRead(writeBuffer *wb, FILE *file){
+    uint64_t counts[4];
+    uint32_t count;
+    if (fread(counts, sizeof(counts), 1, file) != 1 || fread(&count, sizeof(count), 1, file) != 1 || count > wb->capacity){
+        return -1;
+    }
+    for (uint32_t e = 0; e < count; e++){
+        if (fread(&wb->blocks[e], sizeof(addr_t), 1, file) != 1 || fread(&wb->masks[e], sizeof(uint64_t), 1, file) != 1){
+            return -1;
+        }
+    }
+    wb->head = 0;
+    wb->count = count;
+    wb->writes = counts[0];
+    wb->coalesced = counts[1];
+    wb->drains = counts[2];
+    wb->drainedBytes = counts[3];
+    return 0;
+}
+
+void writeBufferFree(writeBuffer *wb){
+    if (wb == NULL){
+        return;
+    }
+    free(wb->blocks);
+    free(wb->masks);
+    free(wb);
+}
+
+/////////////////////////////////////////////////////
+// End of file
+/////////////////////////////////////////////////////
@@ -0,0 +1,48 @@
+/////////////////////////////////////////////////////
+// CSC 252 Project 4
+// Cache Simulator
+// Wilfred Wallis and Chris Dalke
+/////////////////////////////////////////////////////
+// File: writebuf.h
+/////////////////////////////////////////////////////
+
+#ifndef WRITEBUF_H
+#define WRITEBUF_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include "cache.h"
+
+//Most entries -write-buffer accepts
+#define WRITEBUF_MAX_ENTRIES 1024
+
+//Coalescing write buffer between a cache and memory.
+//Each entry is one block with a mask of the bytes written to it.
+typedef struct {
+    addr_t *blocks;         //block number of each entry, a FIFO from head
+    uint64_t *masks;        //one bit per chunk of the block that holds new data
+    uint32_t capacity;
+    uint32_t count;
+    uint32_t head;
+    uint32_t offsetBits;    //log2 of the line size
+    uint32_t chunkShift;    //log2 of the bytes each mask bit stands for
+
+    //Statistics
+    uint64_t writes;        //stores and writebacks put in
+    uint64_t coalesced;     //writes merged into an entry already waiting
+    uint64_t drains;        //entries written to memory, each when a new block needed room
+    uint64_t drainedBytes;
+} writeBuffer;
+
+writeBuffer *writeBufferCreate(uint32_t entries, uint32_t line);
+uint32_t writeBufferPut(writeBuffer *wb, addr_t address, uint32_t bytes);
+uint64_t writeBufferPendingBytes(const writeBuffer *wb);
+int writeBufferWrite(const writeBuffer *wb, FILE *file);
+int writeBufferRead(writeBuffer *wb, FILE *file);
+void writeBufferFree(writeBuffer *wb);
+
+#endif
+
+/////////////////////////////////////////////////////
+// End of file
+/////////////////////////////////////////////////////